@@ -0,0 +1,66 @@
+#include "Collections/LinkedList.hpp"
+#include "Collections/NodePool.hpp"
+#include "Event.hpp"
+#include "LogEngine.hpp"
+#include "OperativeSystem.hpp"
+#include "rngs.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <new>
+
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if (void *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+template <typename Allocator> void QueueChurn(const char *name, long operations)
+{
+    DoubleLinkedList<Event, Allocator> queue{};
+    for (int i = 0; i < 20; i++)
+        queue.Enqueue(Event{(uint64_t)i, ARRIVAL, 0, 0, 0, 0});
+    size_t before = allocations;
+    for (long i = 0; i < operations; i++)
+        queue.Enqueue(queue.Dequeue());
+    fmt::println("{:<12} queue churn: {:.3f} allocations per enqueue/dequeue", name,
+                 (double)(allocations - before) / operations);
+    queue.Clear();
+}
+
+int main(int argc, char **argv)
+{
+    long events = argc > 1 ? atol(argv[1]) : 1000000;
+    LogEngine::CreateInstance("alloc_bench.txt");
+    LogEngine::Instance()->PrintStdout(false);
+
+    QueueChurn<HeapNodeAllocator<Event>>("heap", events);
+    QueueChurn<PooledNodeAllocator<Event>>("pooled", events);
+
+    RandomStream::Global().PlantSeeds(123456789);
+    OS os{};
+    os.Initialize();
+    for (long i = 0; i < events / 10; i++)
+        os.Execute();
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < events; i++)
+        os.Execute();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fmt::println("event loop: {:.3f} allocations per event, {:.0f} events/s, {} pooled nodes",
+                 (double)(allocations - before) / events, events / elapsed, os.EventNodes()->Capacity());
+}
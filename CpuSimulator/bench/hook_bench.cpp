@@ -0,0 +1,96 @@
+#include "Event.hpp"
+#include "Hooks.hpp"
+#include "LogEngine.hpp"
+#include "Station.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <functional>
+#include <vector>
+
+// the hooks of a station before HookList, dispatched as the old BaseStation::Process did
+struct FunctionHooks
+{
+    std::vector<std::function<void(BaseStation *, Event &)>> always{};
+    std::vector<std::function<void(BaseStation *, Event &)>> once{};
+};
+
+struct ListHooks
+{
+    HookList<BaseStation *, Event &> always{};
+    HookList<BaseStation *, Event &> once{};
+};
+
+// out of line on members like Process, so the compiler cannot prove the once lists empty and drop them
+[[gnu::noinline]] static void Dispatch(FunctionHooks &hooks, Event &evt)
+{
+    for (auto &f : hooks.always)
+        f(nullptr, evt);
+    for (auto &f : hooks.once)
+        f(nullptr, evt);
+    hooks.once.clear();
+}
+
+[[gnu::noinline]] static void Dispatch(ListHooks &hooks, Event &evt)
+{
+    hooks.always.Dispatch(nullptr, evt);
+    if (!hooks.once.Empty())
+        hooks.once.DispatchOnce(nullptr, evt);
+}
+
+template <typename F> static double Time(long events, F &&dispatch)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < events; i++)
+        dispatch(i);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return elapsed * 1e9 / events;
+}
+
+int main(int argc, char **argv)
+{
+    long events = argc > 1 ? atol(argv[1]) : 10000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    LogEngine::CreateInstance("hook_bench.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    long counter = 0;
+    Event evt{0, EventType::ARRIVAL, 0, 0, 0, 0};
+
+    // the two hooks every simulation installs on a station
+    FunctionHooks functions{};
+    functions.always.push_back([&counter](auto, Event &e) { counter += e.Id; });
+    functions.always.push_back([&counter](auto, Event &) { counter++; });
+    ListHooks hooks{};
+    hooks.always.Add(1, [&counter](auto, Event &e) { counter += e.Id; });
+    hooks.always.Add(2, [&counter](auto, Event &) { counter++; });
+
+    // whole Process of a station with the same hooks, arrivals and departures alternating
+    BaseStation station{"bench"};
+    station.OnArrival([&counter](auto, Event &e) { counter += e.Id; });
+    station.OnDeparture([&counter](auto, Event &) { counter++; });
+
+    // the cases alternate and the best round is kept, whichever ran first or second would otherwise win
+    double function = 1e9, list = 1e9, process = 1e9;
+    for (int r = 0; r < rounds; r++)
+    {
+        function = std::min(function, Time(events, [&](long i) {
+                                evt.Id = i;
+                                Dispatch(functions, evt);
+                            }));
+        list = std::min(list, Time(events, [&](long i) {
+                            evt.Id = i;
+                            Dispatch(hooks, evt);
+                        }));
+        process = std::min(process, Time(events, [&](long i) {
+                               evt.Id = i / 2;
+                               evt.OccurTime = r * events + i;
+                               evt.Type = i % 2 == 0 ? EventType::ARRIVAL : EventType::DEPARTURE;
+                               station.Process(evt);
+                           }));
+    }
+    fmt::println("{:<32} {:.2f} ns per event", "std::function vector", function);
+    fmt::println("{:<32} {:.2f} ns per event", "HookList", list);
+    fmt::println("{:<32} {:.2f} ns per event", "BaseStation::Process", process);
+    fmt::println("checksum {}", counter);
+}
@@ -2,6 +2,7 @@ import io
 import platform
 import os
 import subprocess
+import numpy as np
 import pandas as pd
 
 class SimulatorCommander():
@@ -93,6 +94,23 @@ class SimulatorCommander():
     pass
 
 
+def load_samples(path: str) -> np.ndarray:
+    # spill file of a BufferedMeasure, e.g. the spillresponses command: raw float64 in native byte order, mapped read only without copying
+    if os.path.getsize(path) == 0:
+        return np.empty(0)
+    return np.memmap(path, dtype=np.float64, mode="r")
+
+
+def batch_means(samples: np.ndarray, batches: int) -> np.ndarray:
+    size = len(samples) // batches
+    return np.asarray(samples[:size * batches]).reshape(batches, size).mean(axis=1)
+
+
+def autocorrelation(samples: np.ndarray, lag: int) -> float:
+    mean = samples.mean()
+    variance = ((samples - mean) ** 2).mean()
+    return float(((samples[:-lag] - mean) * (samples[lag:] - mean)).mean() / variance)
+
 
 if __name__ == "__main__":
     comm = SimulatorCommander("C:/Users/matteo.ielacqua/OneDrive - INPECO SPA/Desktop/Personal/NextEventSimulator/build/Scheduler/scheduler.exe")
@@ -9,14 +9,17 @@
 #include <memory>
 #include <optional>
 
-class Cpu : public Station, public IQueueHolder
+class Cpu final : public Station, public IQueueHolder
 {
 
   private:
     std::optional<Event> _eventUnderProcess{};
 
     IScheduler *_scheduler;
-
+    VariableStream _sliceStream;
+    // built on first use, once the scenario has set the routing and burst parameters
+    std::optional<Router> _router{};
+    std::optional<CompositionStream> _hyperExp{};
 
   public:
     Cpu(IScheduler *scheduler);
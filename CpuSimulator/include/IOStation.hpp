@@ -3,7 +3,7 @@
 #include "rngs.hpp"
 #include <memory>
 
-class IOStation : public FCFSStation
+class IOStation final : public FCFSStation
 {
   private:
     VariableStream _serviceTime;
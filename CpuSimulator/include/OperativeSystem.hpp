@@ -1,9 +1,18 @@
 #pragma once
+#include "CPU.hpp"
+#include "DelayStation.hpp"
 #include "Event.hpp"
+#include "IOStation.hpp"
 #include "ISimulator.hpp"
-#include "Scheduler.hpp"
+#include "ReserveStation.hpp"
+#include "StaticScheduler.hpp"
+#include "SwapIn.hpp"
+#include "SwapOut.hpp"
 
-class OS : public ISimulator, public Scheduler
+// the topology never changes, events reach the stations without virtual calls
+using OSScheduler = StaticScheduler<DelayStation, SwapOut, Cpu, ReserveStation, IOStation, SwapIn>;
+
+class OS : public ISimulator, public OSScheduler
 {
   private:
     bool _end = false;
@@ -14,7 +23,7 @@ class OS : public ISimulator, public Scheduler
   public:
     void Execute() override;
     void Reset() override;
-    OS();
+    OS(RandomStream &generator = RandomStream::Global());
     void Initialize() override;
 
     virtual void ProcessArrival(Event &evt) override;
@@ -0,0 +1,81 @@
+#pragma once
+#include "LogEngine.hpp"
+#include "SimulationEnv.hpp"
+#include "SimulationResult.hpp"
+#include "SystemParameters.hpp"
+#include "rngs.hpp"
+#include <istream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SweepAxis
+{
+    std::string name;
+    std::vector<double> values;
+};
+
+// one grid point, the measures are NAN when the point collected no sample or could not regenerate
+struct SweepRow
+{
+    std::vector<double> parameters{};
+    std::vector<double> measures{};
+    // regeneration cycles completed, 0 for a point that was skipped
+    int cycles = 0;
+};
+
+/**
+ * @brief Runs a scenario on every point of a grid of SystemParameters and gathers one table of results.
+ * @note Every point is an isolated simulation with its own parameters, made current on the worker thread through
+ * SystemParameters::Scope, so points run on all the cores while the scenario and the stations keep reading
+ * SystemParameters::Parameters(). The grid values are applied before the scenario setup, so the stations are built
+ * with them, and again after it, so they override the defaults of the scenario. Every point gets a new generator and
+ * SimulationContext seeded alike, so the points share common random numbers and their differences are not hidden by
+ * the noise of different streams. A point whose regeneration state needs more customers than numclients is skipped,
+ * one that runs SimulationContext::EVENTS_PER_CYCLE events without regenerating is stopped; both rows are NAN.
+ */
+class ParameterSweep
+{
+  private:
+    BaseScenario *_scenario;
+    int _threads;
+    long _seed;
+    RandomEngine _engine;
+    // starting point of every grid point, the parameters current when the sweep is built
+    SystemParameters _base;
+    std::vector<SweepAxis> _axes{};
+    std::vector<SweepRow> _rows{};
+    TraceSource _logger{"ParameterSweep", 1};
+
+  public:
+    // every row holds the mean clients and the mean wait of these stations, then the active time and its precision
+    static inline const std::vector<std::string> STATIONS = {"CPU", "IO1", "IO2", "SWAP_IN"};
+
+    ParameterSweep(BaseScenario *scenario, int threads = std::thread::hardware_concurrency(), long seed = DEFAULT,
+                   RandomEngine engine = RandomEngine::LEHMER);
+
+    // adds an axis, false if SystemParameters has no numeric parameter with that name
+    bool Axis(std::string name, std::vector<double> values);
+    // one axis per line as name,value,value... where a value first:last:step expands to a range, # starts a comment
+    bool Parse(std::istream &spec);
+    bool Load(const std::string &path);
+
+    // points of the grid, the product of the sizes of the axes
+    size_t Points() const;
+    // values of the axes at a point, the last axis changes fastest
+    std::vector<double> Point(size_t index) const;
+
+    void Run(int cycles);
+    // writes a header and one line per point, in the order of Point, the cycles completed last
+    bool Write(const std::string &path);
+
+    const std::vector<SweepAxis> &Axes() const
+    {
+        return _axes;
+    }
+
+    const std::vector<SweepRow> &Rows() const
+    {
+        return _rows;
+    }
+};
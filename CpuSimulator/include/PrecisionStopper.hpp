@@ -0,0 +1,43 @@
+#pragma once
+#include "LogEngine.hpp"
+#include "SimulationResult.hpp"
+
+/**
+ * @brief Decides when a run reached the required precision on every target of a SimulationResult.
+ * @note The targets are evaluated only at the cycles scheduled by the previous check: the next check is placed where
+ * the slowest target is predicted to be ready, from the samples it still needs, but never further than growth times
+ * the cycles run so far, nor closer than a tenth of that. Checks are then logarithmic in the run length and the run
+ * stops at most one short step late.
+ */
+class PrecisionStopper
+{
+  private:
+    int _minCycles;
+    double _growth;
+    int _nextCheck;
+    int _checks = 0;
+    double _needs = INFINITY;
+    TraceSource _logger{"PrecisionStopper", 1};
+
+  public:
+    PrecisionStopper(int minCycles = 40, double growth = 1.5);
+
+    // cycles is the number of cycles (or blocks of events) run so far
+    bool Done(SimulationResult &results, int cycles);
+
+    int NextCheck() const
+    {
+        return _nextCheck;
+    }
+
+    int Checks() const
+    {
+        return _checks;
+    }
+
+    // samples needed over samples collected by the slowest target at the last check
+    double Needs() const
+    {
+        return _needs;
+    }
+};
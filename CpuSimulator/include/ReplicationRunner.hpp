@@ -0,0 +1,59 @@
+#pragma once
+#include "LogEngine.hpp"
+#include "SimulationEnv.hpp"
+#include "SimulationResult.hpp"
+#include "rngs.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs independent replications of a scenario on a pool of threads.
+ * @note Every replica owns its generator, OS, regeneration point and results. Replica r plants the base seed in
+ * xoshiro streams and moves r long jumps (2^192 draws) ahead, so the replicas never share a number. The Lehmer streams
+ * are 8,367,782 draws apart and split among R replicas they would overlap after a few hundred thousand draws, so they
+ * are kept only for a single replication, which reproduces the published results; more replications switch to
+ * xoshiro before any seed is planted. Every cycle of a replica is bounded by SimulationContext::EVENTS_PER_CYCLE
+ * events, Run reports the replicas that stopped short.
+ */
+class ReplicationRunner
+{
+  private:
+    BaseScenario *_scenario;
+    int _threads;
+    RandomEngine _engine;
+    std::vector<std::unique_ptr<SimulationContext>> _replicas{};
+    std::vector<std::unique_ptr<RandomStream>> _streams{};
+    // cycles every replica completed in the last Run
+    std::vector<int> _completed{};
+    TraceSource _logger{"ReplicationRunner", 1};
+
+  public:
+    ReplicationRunner(BaseScenario *scenario, int replications, int threads = std::thread::hardware_concurrency(),
+                      long seed = DEFAULT, RandomEngine engine = RandomEngine::XOSHIRO256PP);
+
+    // runs cycles regeneration cycles on every replica, true if all of them completed
+    bool Run(int cycles);
+    void MergeInto(SimulationResult &result) const;
+
+    int Replications() const
+    {
+        return (int)_replicas.size();
+    }
+
+    // cycles the replica completed in the last Run
+    int Completed(int replica) const
+    {
+        return _completed[replica];
+    }
+
+    RandomEngine Engine() const
+    {
+        return _engine;
+    }
+
+    SimulationContext &operator[](int replica)
+    {
+        return *_replicas[replica];
+    }
+};
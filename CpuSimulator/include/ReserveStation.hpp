@@ -2,7 +2,7 @@
 #include "FCFSStation.hpp"
 #include "rngs.hpp"
 
-class ReserveStation : public FCFSStation
+class ReserveStation final : public FCFSStation
 {
   protected:
     int _multiProgrammingDegree;
@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <fmt/core.h>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <sstream>
@@ -24,18 +25,36 @@
 
 void SetupEnvironment();
 struct BaseScenario;
-struct SimulationManager
+
+// an OS with its regeneration point and results, independent from every other context that has its own generator
+struct SimulationContext
+{
+    RandomStream *generator;
+    std::unique_ptr<OS> os;
+    std::unique_ptr<RegenerationPoint> regPoint;
+    SimulationResult results{};
+
+    // budget of a single regeneration cycle, ten times the longest cycle of Default
+    static constexpr size_t EVENTS_PER_CYCLE = 10000000;
+
+    SimulationContext(RandomStream &generator = RandomStream::Global());
+    virtual ~SimulationContext() = default;
+    void Rebuild();
+    void Setup(BaseScenario *scenario);
+    void CollectMeasures();
+    // stops when a cycle runs maxEvents events without regenerating, the cycles completed
+    int RunCycles(int cycles, size_t maxEvents = std::numeric_limits<size_t>::max());
+};
+
+struct SimulationManager : public SimulationContext
 {
 
     MobileMeanMeasure _transition{20, 10};
     std::vector<BaseScenario *> _scenarios{};
     BaseScenario *_currScenario;
     std::vector<std::function<void()>> _collectFunctions{};
-    std::unique_ptr<OS> os;
-    std::unique_ptr<RegenerationPoint> regPoint;
     SimulationShell *shell;
     TraceSource logger{"SIMManager", 1};
-    SimulationResult results{};
     bool hot = false;
     SimulationManager();
 
@@ -57,7 +76,6 @@ struct SimulationManager
 
     void SetupShell(SimulationShell *shell);
     void HReset();
-    void CollectMeasures();
 
   private:
     void SetupScenario(std::string name);
@@ -69,11 +87,14 @@ struct SimulationManager
     void select_scenario(const char *ctx);
     void perform_number_regeneration(const char *ctx);
     void search_states(const char *ctx);
+    void perform_replications(const char *ctx);
+    void perform_sweep(const char *ctx);
+    void record_trace(const char *ctx);
 };
 
 struct BaseScenario
 {
-    virtual void Setup(SimulationManager *manager) = 0;
+    virtual void Setup(SimulationContext *context) = 0;
     std::string name;
     BaseScenario(std::string name) : name(name)
     {
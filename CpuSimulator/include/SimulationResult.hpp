@@ -5,11 +5,15 @@
 #include "Scheduler.hpp"
 #include "Shell/SimulationShell.hpp"
 #include "Station.hpp"
+#include "StationTable.hpp"
 #include "Strategies/TaggedCustomer.hpp"
+#include <array>
 #include <fmt/core.h>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -20,20 +24,42 @@ struct ConfidenceHits
     int meanwaits = 0;
     int meanclients = 0;
     int activeTimes = 0;
+    // replications accumulated, the flags of a merge hold only if they hold in every replication
+    int collected = 0;
     bool throughput_in = false;
     bool utilization_in = false;
     bool meanClients_in = false;
     bool meanWaits_in = false;
     bool activeTime_in = false;
     void Accumulate(bool x_in, bool u_in, bool n_in, bool w_in, bool activeTime_in);
+    void Merge(const ConfidenceHits &other);
 };
 
 auto format_as(ConfidenceHits b);
 
+enum class Estimator
+{
+    // ratio estimators over the cycles between two regeneration points
+    REGENERATIVE,
+    // batch means of the response times and of the cycle time, no regeneration state needed
+    BATCH_MEANS
+};
+
 struct StationStats
 {
     CovariatedMeasure _acc[4];
-    void Collect(BaseStation *station);
+    QuantileMeasure responseTime{"responseTime", "ms"};
+    // response time of every visit, filled only by the batch means estimator
+    BatchMeansMeasure batchWait{"meanwaits", "ms"};
+    // cycles are collected only after the transitory period of this station, the detector survives Reset
+    WarmupDetector warmup{};
+    // area, completions and observation time of the cycles pushed to the detector, the ones after its truncation
+    // point are collected when the transitory period ends
+    std::vector<std::array<double, 3>> pending{};
+    // statistics of a station as of clock from its record in the table, the station does not need to be synced
+    void Collect(const StationCounters &counters, const QuantileMeasure *responseTimes, double clock);
+    void CollectCycle(double areaN, double completions, double observation);
+    void RestartWarmup();
     StationStats();
     enum MeasureType
     {
@@ -46,7 +72,12 @@ struct StationStats
 
     CovariatedMeasure &operator[](StationStats::MeasureType measure);
     void Reset();
-    bool Ready();
+    // samples needed over samples collected by the slowest measure, at most 1 once all reached the precision
+    double Needs(Estimator estimator);
+    bool Ready(Estimator estimator);
+    void Merge(const StationStats &other);
+    void Serialize(std::string &out) const;
+    bool Deserialize(std::string_view &in);
 };
 
 auto format_as(StationStats stats);
@@ -55,8 +86,14 @@ struct SimulationResult
 {
     static inline double requiredPrecision = 0.05;
     static inline double confidence = 0.90;
+    // set through UseEstimator, every result has its own so concurrent runs do not share them
+    Estimator estimator = Estimator::REGENERATIVE;
+    // samples of every batch means measure discarded as transitory
+    size_t batchWarmup = 0;
     std::map<std::string, StationStats> _acc;
     Accumulator<> _activeTime{"activeTime", "ms"};
+    // response times of single stations appended to a file for the scripts, see the spillresponses command
+    std::map<std::string, std::unique_ptr<BufferedMeasure<>>> _spilledResponses{};
     std::vector<std::string> _precisionTargets = {"CPU", "IO1", "IO2", "ActiveTime"};
     MVASolver mva{};
     std::map<std::string, ConfidenceHits> _confidenceHits{};
@@ -68,15 +105,32 @@ struct SimulationResult
     SimulationResult();
     void AddShellCommands(SimulationShell *shell);
     void Reset();
-    void Collect(BaseStation *station);
+    void Collect(const BaseStation &station, const StationCounters &counters, double clock);
+    // statistics of a station, created with the batch warmup of this result
+    StationStats &Stats(const std::string &station);
+    // switches the estimator and the samples its batch means discard, the measures collected so far are dropped
+    void UseEstimator(Estimator estimator, size_t warmup = 0);
     void CollectCustomMeasure(std::string name, double value, double clock);
+    // after the transitory period, non finite values are logged and discarded
     void CollectActiveTime(double value);
+    // response time of the visit that just ended at station, used by the batch means estimator and the spill files
+    void CollectResponse(BaseStation *station);
+    // samples needed over samples collected by a precision target, at most 1 once it reached requiredPrecision
+    double TargetNeeds(const std::string &target);
     bool PrecisionReached();
     void LogSimResults();
+    // true until the tagged customer and every station left their transitory period
     bool IsTransitoryPeriod();
+    // a new run starts, every measure has to detect its transitory period again
+    void RestartWarmup();
     void AddPrecisionTarget(std::string name)
     {
         _precisionTargets.push_back(name);
     }
     void LogResult(std::string name = "ALL");
+    // combines the results of another worker, samples are not needed so the order of the merges does not matter
+    void Merge(const SimulationResult &other);
+    void Serialize(std::string &out) const;
+    // replaces the measures with the ones written by Serialize
+    bool Deserialize(std::string_view &in);
 };
@@ -4,7 +4,7 @@
 #include "rngs.hpp"
 #include <memory>
 
-class SwapIn : public FCFSStation
+class SwapIn final : public FCFSStation
 {
   public:
     SwapIn(IScheduler *scheduler);
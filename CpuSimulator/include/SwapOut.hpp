@@ -5,16 +5,17 @@
 
 #include "ISimulator.hpp"
 #include "Station.hpp"
+#include "rngs.hpp"
 
-class SwapOut : public Station
+class SwapOut final : public Station
 {
   protected:
     IScheduler *_scheduler;
+    Router _router;
 
   public:
     SwapOut(IScheduler *scheduler);
 
-  protected:
     void ProcessArrival(Event &evt) override;
     void ProcessDeparture(Event &evt) override;
 };
\ No newline at end of file
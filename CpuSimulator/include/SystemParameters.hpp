@@ -3,7 +3,10 @@
 #include "Shell/SimulationShell.hpp"
 #include <cstdlib>
 #include <cstring>
+#include <map>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <vector>
 struct SystemParameters
 {
@@ -29,10 +32,55 @@ struct SystemParameters
     int slicemode = FIXED;
     int burstMode = HYPER_EXP;
     int groupRegCycle = 1;
+    // the parameters of the simulations run by this thread, the shared instance unless a Scope is active
     static SystemParameters &Parameters()
     {
         static SystemParameters instance = SystemParameters{};
-        return instance;
+        return Local() != nullptr ? *Local() : instance;
+    }
+
+    /**
+     * @brief Makes Parameters() return params on the calling thread while the scope lives.
+     * @note Stations read their parameters while the simulation runs, so the scope has to outlive the run and not
+     * only the scenario setup. Scopes nest, the previous parameters are restored on destruction.
+     */
+    class Scope
+    {
+      private:
+        SystemParameters *_previous;
+
+      public:
+        Scope(SystemParameters &params) : _previous(Local())
+        {
+            Local() = &params;
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope()
+        {
+            Local() = _previous;
+        }
+    };
+
+    // numeric parameter by name, integers are truncated, false if there is no such parameter
+    bool Set(const std::string &name, double value)
+    {
+        if (auto itr = Doubles().find(name); itr != Doubles().end())
+            this->*(itr->second) = value;
+        else if (auto itr = Integers().find(name); itr != Integers().end())
+            this->*(itr->second) = (int)value;
+        else
+            return false;
+        return true;
+    }
+
+    std::optional<double> Get(const std::string &name) const
+    {
+        if (auto itr = Doubles().find(name); itr != Doubles().end())
+            return this->*(itr->second);
+        if (auto itr = Integers().find(name); itr != Integers().end())
+            return this->*(itr->second);
+        return {};
     }
 
     void AddControlCommands(SimulationShell *shell)
@@ -43,4 +91,37 @@ struct SystemParameters
                                   p.numclients, p.averageSwapIn);
         });
     }
+
+  private:
+    static SystemParameters *&Local()
+    {
+        thread_local SystemParameters *local = nullptr;
+        return local;
+    }
+
+    static const std::map<std::string, double SystemParameters::*> &Doubles()
+    {
+        static const std::map<std::string, double SystemParameters::*> doubles{
+            {"workStationThinkTime", &SystemParameters::workStationThinkTime},
+            {"averageSwapIn", &SystemParameters::averageSwapIn},
+            {"cpuQuantum", &SystemParameters::cpuQuantum},
+            {"averageIO1", &SystemParameters::averageIO1},
+            {"averageIO2", &SystemParameters::averageIO2},
+            {"alpha", &SystemParameters::alpha},
+            {"beta", &SystemParameters::beta},
+            {"u1", &SystemParameters::u1},
+            {"u2", &SystemParameters::u2}};
+        return doubles;
+    }
+
+    static const std::map<std::string, int SystemParameters::*> &Integers()
+    {
+        static const std::map<std::string, int SystemParameters::*> integers{
+            {"multiProgrammingDegree", &SystemParameters::multiProgrammingDegree},
+            {"numclients", &SystemParameters::numclients},
+            {"slicemode", &SystemParameters::slicemode},
+            {"burstMode", &SystemParameters::burstMode},
+            {"groupRegCycle", &SystemParameters::groupRegCycle}};
+        return integers;
+    }
 };
@@ -12,7 +12,10 @@
 
 // burst is written this way because of this
 // https://rossetti.github.io/RossettiArenaBook/app-rnrv-rvs.html#AppRNRV:subsec:MTSRV
-Cpu::Cpu(IScheduler *scheduler) : Station("CPU", Stations::CPU), _scheduler(scheduler)
+Cpu::Cpu(IScheduler *scheduler)
+    : Station("CPU", Stations::CPU), IQueueHolder(scheduler), _scheduler(scheduler),
+      _sliceStream(scheduler->Generator(), 99,
+                   [](auto &rng) { return Exponential(SystemParameters::Parameters().cpuQuantum, rng); })
 {
 }
 
@@ -33,12 +36,9 @@ void Cpu::ProcessArrival(Event &evt)
 
 void Cpu::Manage(Event &evt)
 {
-    static VariableStream sliceStream{99,
-                                      [](auto rng) { return Exponential(SystemParameters::Parameters().cpuQuantum); }};
-
     auto quantum = SystemParameters::Parameters().slicemode == SystemParameters::FIXED
                        ? SystemParameters::Parameters().cpuQuantum
-                       : sliceStream();
+                       : _sliceStream();
                            evt.Type = DEPARTURE;
     if(SystemParameters::Parameters().burstMode == SystemParameters::FIXED){
         evt.ServiceTime = Burst();
@@ -52,8 +52,9 @@ void Cpu::Manage(Event &evt)
 
 void Cpu::ProcessDeparture(Event &evt)
 {
-
-    static Router router(4, SystemParameters::Parameters().cpuChoice, {IO_1, IO_2, SWAP_OUT, CPU});
+    if (!_router.has_value())
+        _router.emplace(_scheduler->Generator(), 4, SystemParameters::Parameters().cpuChoice,
+                        std::vector<int>{IO_1, IO_2, SWAP_OUT, CPU});
     // process has finished
     core_assert(_eventUnderProcess.has_value(), "Event {} in departure but no event under process", evt);
     core_assert(evt == _eventUnderProcess.value(), "Event {} scheduled for departure but other event in process {}",
@@ -62,7 +63,7 @@ void Cpu::ProcessDeparture(Event &evt)
     if (evt.ServiceTime == 0)
     {
         evt.Type = ARRIVAL;
-        evt.Station = router();
+        evt.Station = (*_router)();
         evt.SubType = 0;
         _scheduler->Schedule(evt);
         Station::ProcessDeparture(evt);
@@ -70,7 +71,7 @@ void Cpu::ProcessDeparture(Event &evt)
     else
     {
         _eventList.Enqueue(evt);
-        _completions++;
+        Counters().completions++;
     }
     if (_eventList.Count() > 0)
     {
@@ -83,10 +84,11 @@ void Cpu::ProcessDeparture(Event &evt)
 
 double Cpu::Burst()
 {
-    static CompositionStream hyperExp{3,
-                                      {SystemParameters::Parameters().alpha, SystemParameters::Parameters().beta},
-                                      [](auto rng) { return Exponential(SystemParameters::Parameters().u1); },
-                                      [](auto rng) { return Exponential(SystemParameters::Parameters().u2); }};
-
-    return hyperExp();
+    if (!_hyperExp.has_value())
+        _hyperExp.emplace(
+            _scheduler->Generator(), 3,
+            std::vector<double>{SystemParameters::Parameters().alpha, SystemParameters::Parameters().beta},
+            [](auto &rng) { return Exponential(SystemParameters::Parameters().u1, rng); },
+            [](auto &rng) { return Exponential(SystemParameters::Parameters().u2, rng); });
+    return (*_hyperExp)();
 }
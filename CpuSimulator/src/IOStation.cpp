@@ -24,12 +24,12 @@ void IOStation::ProcessDeparture(Event &evt)
 }
 
 IOStation::IOStation(IScheduler *scheduler, int stationIndex)
-    : _serviceTime(VariableStream(5,
-                                  [this](auto rng) {
+    : _serviceTime(VariableStream(scheduler->Generator(), 5,
+                                  [this](auto &rng) {
                                       if (_stationIndex == IO_1)
-                                          return Exponential(SystemParameters::Parameters().averageIO1);
+                                          return Exponential(SystemParameters::Parameters().averageIO1, rng);
                                       else if (_stationIndex == IO_2)
-                                          return Exponential(SystemParameters::Parameters().averageIO2);
+                                          return Exponential(SystemParameters::Parameters().averageIO2, rng);
                                       panic(fmt::format("Index {} is not right for this station", _stationIndex));
                                       return 0.0;
                                   })),
@@ -17,27 +17,30 @@
 
 void OS::Execute()
 {
-    auto nextEvt = _eventList.Dequeue();
+    auto nextEvt = _eventList->Dequeue();
+    RecordEvent(nextEvt);
     _clock = nextEvt.OccurTime;
     Process(nextEvt);
     Route(nextEvt);
     processedEvents++;
-    if (_eventList.Count() == 0)
+    if (_eventList->Count() == 0)
     {
         panic(fmt::format("Error eventlist is empty, last event processed {}, processed events {}", nextEvt,
                           processedEvents));
     }
 }
 
-OS::OS() : Scheduler("OS")
+OS::OS(RandomStream &generator) : OSScheduler("OS", EventQueueType::BINARY_HEAP, generator)
 {
     DelayStation *dstation = new DelayStation(
         this, "delay_station",
-        [dstation]() {
-            static VariableStream delayStream(
-                1, [](auto rng) { return Exponential(SystemParameters::Parameters().workStationThinkTime); });
-            return delayStream();
-        },
+        [delayStream = VariableStream(generator, 1,
+                                      [](auto &rng) {
+                                          return Exponential(SystemParameters::Parameters().workStationThinkTime, rng);
+                                      })
+                           .WithBuffer(64, [](auto out, auto &rng) {
+                               Exponential(SystemParameters::Parameters().workStationThinkTime, out, rng);
+                           })]() mutable { return delayStream(); },
         []() { return SystemParameters::Parameters().numclients; });
 
     dstation->OnDeparture([this](auto s, Event &evt) {
@@ -62,12 +65,7 @@ void OS::Reset()
 {
 
     _end = false;
-    for (auto station : _stations)
-    {
-        auto evt = Event{"PROBE", PROBE, _clock, _clock, 0, 0, 0};
-        station->Process(evt);
-        station->Reset();
-    }
+    OSScheduler::Reset();
 }
 
 void OS::Initialize()
@@ -77,5 +75,5 @@ void OS::Initialize()
 
 void OS::ProcessProbe(Event &evt)
 {
-    Scheduler::ProcessProbe(evt);
+    OSScheduler::ProcessProbe(evt);
 }
@@ -0,0 +1,224 @@
+#include "ParameterSweep.hpp"
+#include "Core.hpp"
+#include "SimulationEnv.hpp"
+#include "SimulationResult.hpp"
+#include "SystemParameters.hpp"
+#include "rngs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+ParameterSweep::ParameterSweep(BaseScenario *scenario, int threads, long seed, RandomEngine engine)
+    : _scenario(scenario), _threads(std::max(threads, 1)), _seed(seed), _engine(engine),
+      _base(SystemParameters::Parameters())
+{
+}
+
+bool ParameterSweep::Axis(std::string name, std::vector<double> values)
+{
+    if (!_base.Get(name).has_value())
+    {
+        _logger.Exception("Cannot sweep {}, it is not a numeric parameter", name);
+        return false;
+    }
+    if (values.empty())
+    {
+        _logger.Exception("Axis {} has no values", name);
+        return false;
+    }
+    _axes.push_back(SweepAxis{std::move(name), std::move(values)});
+    return true;
+}
+
+static bool ParseNumber(const std::string &text, double &value)
+{
+    char *end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size();
+}
+
+static std::string Trim(const std::string &text)
+{
+    auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return "";
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool ParameterSweep::Parse(std::istream &spec)
+{
+    std::string line{};
+    for (int number = 1; std::getline(spec, line); number++)
+    {
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        std::stringstream cells{line};
+        std::string name{};
+        std::getline(cells, name, ',');
+        std::vector<double> values{};
+        for (std::string cell{}; std::getline(cells, cell, ',');)
+        {
+            cell = Trim(cell);
+            auto colon = cell.find(':');
+            double first, last, step;
+            if (colon == std::string::npos && ParseNumber(cell, first))
+                values.push_back(first);
+            else if (colon != std::string::npos && cell.find(':', colon + 1) != std::string::npos &&
+                     ParseNumber(cell.substr(0, colon), first) &&
+                     ParseNumber(cell.substr(colon + 1, cell.rfind(':') - colon - 1), last) &&
+                     ParseNumber(cell.substr(cell.rfind(':') + 1), step) && step > 0 && first <= last)
+            {
+                // counted rather than accumulated, so the last value is not lost to rounding
+                long count = std::lround(std::floor((last - first) / step + 1e-9)) + 1;
+                for (long i = 0; i < count; i++)
+                    values.push_back(first + i * step);
+            }
+            else
+            {
+                _logger.Exception("Line {}: cannot read {} as a value or a first:last:step range", number, cell);
+                return false;
+            }
+        }
+        if (!Axis(Trim(name), std::move(values)))
+            return false;
+    }
+    return true;
+}
+
+bool ParameterSweep::Load(const std::string &path)
+{
+    std::ifstream spec{path};
+    if (!spec.is_open())
+    {
+        _logger.Exception("Cannot open sweep spec {}", path);
+        return false;
+    }
+    return Parse(spec);
+}
+
+size_t ParameterSweep::Points() const
+{
+    if (_axes.empty())
+        return 0;
+    size_t points = 1;
+    for (auto &axis : _axes)
+        points *= axis.values.size();
+    return points;
+}
+
+std::vector<double> ParameterSweep::Point(size_t index) const
+{
+    std::vector<double> values(_axes.size());
+    for (size_t a = _axes.size(); a > 0; a--)
+    {
+        auto &axis = _axes[a - 1];
+        values[a - 1] = axis.values[index % axis.values.size()];
+        index /= axis.values.size();
+    }
+    return values;
+}
+
+static double Estimate(CovariatedMeasure &measure)
+{
+    return measure.Count() > 0 ? measure.R() : NAN;
+}
+
+static std::vector<double> Measures(SimulationResult &results)
+{
+    std::vector<double> measures{};
+    for (auto &station : ParameterSweep::STATIONS)
+    {
+        measures.push_back(Estimate(results._acc[station][StationStats::meancustomer]));
+        measures.push_back(Estimate(results._acc[station][StationStats::meanwait]));
+    }
+    auto &activeTime = results.tgt._mean.WithConfidence(SimulationResult::confidence);
+    measures.push_back(Estimate(activeTime));
+    measures.push_back(activeTime.Count() > 1 ? activeTime.confidence().precision() : NAN);
+    return measures;
+}
+
+void ParameterSweep::Run(int cycles)
+{
+    size_t points = Points();
+    _rows.assign(points, SweepRow{});
+    std::atomic<size_t> next{0};
+    auto worker = [this, cycles, points, &next]() {
+        for (size_t p = next++; p < points; p = next++)
+        {
+            auto values = Point(p);
+            SystemParameters params = _base;
+            auto apply = [this, &params, &values]() {
+                for (size_t a = 0; a < _axes.size(); a++)
+                    params.Set(_axes[a].name, values[a]);
+            };
+            // the stations are built with the values of the point, which then override the defaults of the scenario
+            apply();
+            SystemParameters::Scope scope{params};
+            RandomStream generator{_engine};
+            generator.PlantSeeds(_seed);
+            SimulationContext context{generator};
+            context.Setup(_scenario);
+            apply();
+            _rows[p] = SweepRow{values, std::vector<double>(STATIONS.size() * 2 + 2, NAN)};
+            if (context.regPoint->requiredClients() > params.numclients)
+            {
+                _logger.Exception("Point {} skipped, the regeneration state holds {} customers but numclients is {}",
+                                  p, context.regPoint->requiredClients(), params.numclients);
+                continue;
+            }
+            context.os->Initialize();
+            // bounded per cycle, a state that is never reached costs a single budget
+            _rows[p].cycles = context.RunCycles(cycles, SimulationContext::EVENTS_PER_CYCLE);
+            if (_rows[p].cycles < cycles)
+            {
+                _logger.Exception("Point {} stopped after {} of {} regeneration cycles, the state is too rare", p,
+                                  _rows[p].cycles, cycles);
+                continue;
+            }
+            _rows[p].measures = Measures(context.results);
+        }
+    };
+    std::vector<std::thread> pool{};
+    for (int i = 0; i < (int)std::min<size_t>(_threads, points); i++)
+        pool.emplace_back(worker);
+    for (auto &thread : pool)
+        thread.join();
+    _logger.Information("Completed {} points of {} regeneration cycles", points, cycles);
+}
+
+bool ParameterSweep::Write(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        _logger.Exception("Cannot open sweep results {}", path);
+        return false;
+    }
+    std::vector<std::string> header{};
+    for (auto &axis : _axes)
+        header.push_back(axis.name);
+    for (auto &station : STATIONS)
+    {
+        header.push_back(station + "_N");
+        header.push_back(station + "_W");
+    }
+    header.push_back("ActiveTime");
+    header.push_back("ActiveTime_precision");
+    header.push_back("cycles");
+    fmt::print(file, "{}\n", fmt::join(header, ","));
+    for (auto &row : _rows)
+        fmt::print(file, "{},{},{}\n", fmt::join(row.parameters, ","), fmt::join(row.measures, ","), row.cycles);
+    std::fclose(file);
+    return true;
+}
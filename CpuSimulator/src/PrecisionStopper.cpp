@@ -0,0 +1,32 @@
+#include "PrecisionStopper.hpp"
+#include <algorithm>
+#include <cmath>
+
+PrecisionStopper::PrecisionStopper(int minCycles, double growth)
+    : _minCycles(std::max(minCycles, 1)), _growth(std::max(growth, 1.0)), _nextCheck(_minCycles)
+{
+}
+
+bool PrecisionStopper::Done(SimulationResult &results, int cycles)
+{
+    if (cycles < _nextCheck)
+        return false;
+    _checks++;
+    _needs = 0.0;
+    for (auto &target : results._precisionTargets)
+        _needs = std::max(_needs, results.TargetNeeds(target));
+    if (_needs <= 1.0)
+    {
+        _logger.Information("All targets reached precision {} after {} cycles and {} checks",
+                            SimulationResult::requiredPrecision, cycles, _checks);
+        return true;
+    }
+    // the samples grow with the cycles, so the missing fraction of samples is the missing fraction of cycles
+    double step = std::max(1.0, cycles * (_growth - 1.0));
+    if (std::isfinite(_needs))
+        step = std::clamp(std::ceil(cycles * (_needs - 1.0)), std::max(1.0, step / 10), step);
+    _nextCheck = cycles + (int)step;
+    _logger.Information("After {} cycles the slowest target needs {:.2f} times its samples, next check at {}", cycles,
+                        _needs, _nextCheck);
+    return false;
+}
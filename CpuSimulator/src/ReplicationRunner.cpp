@@ -0,0 +1,71 @@
+#include "ReplicationRunner.hpp"
+#include "Core.hpp"
+#include "SimulationEnv.hpp"
+#include "SimulationResult.hpp"
+#include "rngs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fmt/core.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+ReplicationRunner::ReplicationRunner(BaseScenario *scenario, int replications, int threads, long seed,
+                                     RandomEngine engine)
+    : _scenario(scenario), _threads(std::max(threads, 1)), _engine(engine)
+{
+    if (replications < 1)
+        panic(fmt::format("Cannot run {} replications", replications));
+    if (_engine == RandomEngine::LEHMER && replications > 1)
+    {
+        _logger.Exception("The Lehmer streams cannot hold {} independent replications, using xoshiro", replications);
+        _engine = RandomEngine::XOSHIRO256PP;
+    }
+    _logger.Information("Replications:{}, threads:{}", replications, _threads);
+    // setup runs here, one replica at a time, since scenarios write the shared SystemParameters
+    for (int r = 0; r < replications; r++)
+    {
+        auto generator = std::make_unique<RandomStream>(_engine);
+        generator->PlantSeeds(seed);
+        for (int jump = 0; jump < r; jump++)
+            generator->LongJump();
+        auto replica = std::make_unique<SimulationContext>(*generator);
+        replica->Setup(_scenario);
+        replica->os->Initialize();
+        _streams.push_back(std::move(generator));
+        _replicas.push_back(std::move(replica));
+    }
+}
+
+bool ReplicationRunner::Run(int cycles)
+{
+    std::atomic<int> next{0};
+    _completed.assign(Replications(), 0);
+    auto worker = [this, cycles, &next]() {
+        for (int r = next++; r < Replications(); r = next++)
+            _completed[r] = _replicas[r]->RunCycles(cycles, SimulationContext::EVENTS_PER_CYCLE);
+    };
+    std::vector<std::thread> pool{};
+    for (int i = 0; i < std::min(_threads, Replications()); i++)
+        pool.emplace_back(worker);
+    for (auto &thread : pool)
+        thread.join();
+    bool completed = true;
+    for (int r = 0; r < Replications(); r++)
+    {
+        if (_completed[r] < cycles)
+        {
+            _logger.Exception("Replica {} stopped after {} of {} regeneration cycles, its state is too rare", r,
+                              _completed[r], cycles);
+            completed = false;
+        }
+    }
+    _logger.Information("Completed {} regeneration cycles on {} replications", cycles, Replications());
+    return completed;
+}
+
+void ReplicationRunner::MergeInto(SimulationResult &result) const
+{
+    for (auto &replica : _replicas)
+        result.Merge(replica->results);
+}
@@ -1,3 +1,4 @@
+#include "Core.hpp"
 #include "SimulationEnv.hpp"
 #include "Station.hpp"
 #include "Strategies/RegenerationPoint.hpp"
@@ -10,26 +11,29 @@
 #define SCENARIO(name)                                                                                                 \
     struct _Scenario_##name : public BaseScenario                                                                      \
     {                                                                                                                  \
-        virtual void Setup(SimulationManager *manager) override;                                                       \
+        virtual void Setup(SimulationContext *context) override;                                                       \
         _Scenario_##name() : BaseScenario(#name)                                                                       \
         {                                                                                                              \
         }                                                                                                              \
     };                                                                                                                 \
     _Scenario_##name __##name{};                                                                                       \
-    void _Scenario_##name::Setup(SimulationManager *manager)
+    void _Scenario_##name::Setup(SimulationContext *context)
 
 void AddClientConditionRule(RegenerationPoint *reg, std::vector<std::pair<std::string, int>> rules)
 {
-    for (auto rule : rules)
+    for (auto &rule : rules)
     {
-        reg->AddRule([rule](RegenerationPoint *pt) {
-            return pt->scheduler->GetStation(rule.first).value()->sysClients() == rule.second;
+        auto station = reg->scheduler->GetStation(rule.first);
+        if (!station.has_value())
+            panic(fmt::format("Regeneration rule on unknown station {}", rule.first));
+        reg->AddRule([station = station.value(), clients = rule.second](RegenerationPoint *) {
+            return station->sysClients() == clients;
         });
+        reg->RequireClients(rule.second);
     }
 
-    // add regroup rule
-    reg->AddRule([](auto r) {
-        static int iterations = 0;
+    // add regroup rule, the counter belongs to this regeneration point
+    reg->AddRule([iterations = 0](auto r) mutable {
         iterations++;
         if (iterations % SystemParameters::Parameters().groupRegCycle == 0)
         {
@@ -51,8 +55,8 @@ SCENARIO(Simplified_N20)
     params.multiProgrammingDegree = 1000;
     params.cpuQuantum = 2700;
     params.cpuChoice = std::vector<double>{0.065, 0.025, 0.01, 0.9};
-    auto &regPoint = manager->regPoint;
-    manager->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
+    auto &regPoint = context->regPoint;
+    context->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
     // NDelay:3, NReserve:0, NSwap:0, NCPU:0, NIO1:0, NIO2:16,NOUT:0, hits:24
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 16}, {"delay_station", 3}, {"RESERVE_STATION", 0}});
@@ -63,10 +67,9 @@ SCENARIO(Default) // first request
     auto &params = SystemParameters::Parameters();
     params.cpuQuantum = 2.7;
 
-    auto &regPoint = manager->regPoint;
+    auto &regPoint = context->regPoint;
     // first CPU must have 0 clients because is hyperexp
-    auto os = manager->shell->Scheduler();
-    manager->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
+    context->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
 
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 9}, {"delay_station", 2}, {"RESERVE_STATION", 8}});
@@ -82,8 +85,8 @@ SCENARIO(NegExpCpu) // second request
     params.u1 = 27;
     params.u2 = 27;
 
-    auto &regPoint = manager->regPoint;
-    manager->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
+    auto &regPoint = context->regPoint;
+    context->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 9}, {"delay_station", 2}, {"RESERVE_STATION", 8}});
 }
@@ -93,8 +96,8 @@ SCENARIO(LTCpu) // third request
     auto &params = SystemParameters::Parameters();
     params.cpuQuantum = 2700;
 
-    auto &regPoint = manager->regPoint;
-    manager->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
+    auto &regPoint = context->regPoint;
+    context->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
 
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 9}, {"delay_station", 2}, {"RESERVE_STATION", 8}});
@@ -108,7 +111,7 @@ SCENARIO(NegExpLt) // last request
     params.beta = 0.5;
     params.u1 = 27;
     params.u2 = 27;
-    auto &regPoint = manager->regPoint;
+    auto &regPoint = context->regPoint;
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 9}, {"delay_station", 2}, {"RESERVE_STATION", 8}});
 }
@@ -126,8 +129,8 @@ SCENARIO(Markov_20)
     params.averageSwapIn = 0;
     params.beta = 0.2;
     params.slicemode = SystemParameters::NEG_EXP;
-    auto &regPoint = manager->regPoint;
-    manager->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
+    auto &regPoint = context->regPoint;
+    context->results.tgt.OnEntrance([&regPoint](auto e) { regPoint->Trigger(); });
     AddClientConditionRule(regPoint.get(),
                            {{"CPU", 0}, {"IO1", 0}, {"IO2", 16}, {"delay_station", 3}, {"RESERVE_STATION", 0}
 
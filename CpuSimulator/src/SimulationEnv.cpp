@@ -7,6 +7,9 @@
 #include "Measure.hpp"
 #include "MvaSolver.hpp"
 #include "OperativeSystem.hpp"
+#include "ParameterSweep.hpp"
+#include "PrecisionStopper.hpp"
+#include "ReplicationRunner.hpp"
 #include "Shell/SimulationShell.hpp"
 #include "SimulationResult.hpp"
 #include "Station.hpp"
@@ -26,6 +29,7 @@
 #include <sstream>
 #include <string.h>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -37,9 +41,9 @@ void list_stats(OS *os, TraceSource &logger, const char *c)
     read >> buffer;
     if (strlen(buffer) == 0)
     {
+        os->Sync();
         for (auto s : os->GetStations())
         {
-            os->Sync();
             logger.Result("S:{},B:{},O:{},A:{},C:{},N:{},W:{},MAXN:{},AN:{},AS:{}", s->Name(), s->busyTime(),
                           s->observation(), s->arrivals(), s->completions(), s->sysClients(), s->avg_waiting(),
                           s->max_sys_clients(), s->areaN(), s->areaS());
@@ -65,7 +69,7 @@ void list_stats(OS *os, TraceSource &logger, const char *c)
 
 void show_queue(OS *os, TraceSource &logger)
 {
-    logger.Result("Scheduler Queue:{}", os->EventQueue());
+    logger.Result("Scheduler Queue:{}", fmt::format("{}", os->GetEventQueue()));
     for (auto s : os->GetStations())
     {
         auto p = std::dynamic_pointer_cast<IQueueHolder>(s);
@@ -109,14 +113,14 @@ void attach(const char *context, SimulationShell *shell, bool arrival, OS *os, T
         std::string capName{buffer};
         if (arrival)
             os->GetStation(stat).value()->OnArrivalOnce([&end, capName](auto s, Event &e) {
-                if (e.Name == capName)
+                if (e.Name() == capName)
                 {
                     end = true;
                 }
             });
         else
             os->GetStation(stat).value()->OnDepartureOnce([&end, capName](auto s, Event &e) {
-                if (e.Name == capName)
+                if (e.Name() == capName)
                 {
                     end = true;
                 }
@@ -147,6 +151,7 @@ void SimulationManager::select_scenario(const char *ctx)
     read >> buffer;
     if (strcmp(buffer, "list") == 0)
     {
+        LogLocker lock{};
         for (auto s : _scenarios)
         {
             fmt::println("Scenario: {}", s->name);
@@ -182,14 +187,92 @@ void SimulationManager::perform_number_regeneration(const char *ctx)
     CollectSamples(m);
 }
 
+void SimulationManager::record_trace(const char *ctx)
+{
+    std::string file{};
+    std::stringstream stream{ctx};
+    stream >> file;
+    if (file.empty())
+    {
+        logger.Exception("Usage: trace <file>|off");
+        return;
+    }
+    if (file == "off")
+    {
+        os->StopTrace();
+        return;
+    }
+    if (os->RecordTrace(file))
+        logger.Information("Recording events of the current simulation in {}", file);
+}
+
+void SimulationManager::perform_replications(const char *ctx)
+{
+    std::stringstream stream{ctx};
+    int replications = 0;
+    int cycles = 0;
+    int threads = std::thread::hardware_concurrency();
+    long seed = DEFAULT;
+    stream >> replications >> cycles;
+    if (replications < 1 || cycles < 1)
+    {
+        logger.Exception("Usage: nrep <replications> <cycles> [threads] [seed]");
+        return;
+    }
+    if (!(stream >> threads))
+        threads = std::thread::hardware_concurrency();
+    if (!(stream >> seed))
+        seed = DEFAULT;
+    ReplicationRunner runner{_currScenario, replications, threads, seed};
+    for (int r = 0; r < runner.Replications(); r++)
+        runner[r].results.UseEstimator(results.estimator, results.batchWarmup);
+    runner.Run(cycles);
+    results.Reset();
+    runner.MergeInto(results);
+    for (auto tg : results._precisionTargets)
+    {
+        results.LogResult(tg);
+    }
+}
+
+void SimulationManager::perform_sweep(const char *ctx)
+{
+    std::stringstream stream{ctx};
+    std::string spec{};
+    std::string out{};
+    int cycles = 0;
+    int threads = std::thread::hardware_concurrency();
+    long seed = DEFAULT;
+    stream >> spec >> out >> cycles;
+    if (spec.empty() || out.empty() || cycles < 1)
+    {
+        logger.Exception("Usage: sweep <spec> <results.csv> <cycles> [threads] [seed]");
+        return;
+    }
+    if (!(stream >> threads))
+        threads = std::thread::hardware_concurrency();
+    if (!(stream >> seed))
+        seed = DEFAULT;
+    ParameterSweep sweep{_currScenario, threads, seed, RandomStream::Global().Engine()};
+    if (!sweep.Load(spec) || sweep.Points() == 0)
+        return;
+    sweep.Run(cycles);
+    if (sweep.Write(out))
+        logger.Information("Results of {} points written in {}", sweep.Points(), out);
+}
+
 // endregion COMMANDS
 
-void SimulationManager::CollectMeasures()
+void SimulationContext::CollectMeasures()
 {
-    results.Collect(os->GetStation("CPU")->get());
-    results.Collect(os->GetStation("IO1")->get());
-    results.Collect(os->GetStation("IO2")->get());
-    results.Collect(os->GetStation("SWAP_IN")->get());
+    double clock = os->GetClock();
+    // the counters are read from the table of the scheduler, the stations only give their slot and response times
+    auto &table = os->GetStationTable();
+    for (auto name : {"CPU", "IO1", "IO2", "SWAP_IN"})
+    {
+        auto &station = *os->GetStation(name).value();
+        results.Collect(station, table[station.slot()], clock);
+    }
 
     auto activeTime = [this](std::string name) {
         auto s = os->GetStation(name).value();
@@ -198,10 +281,63 @@ void SimulationManager::CollectMeasures()
 
         return results._acc[name][StationStats::meancustomer].R();
     };
+    // Little's law on the active stations, every customer that becomes active passes through SWAP_IN
     results.CollectActiveTime((activeTime("CPU") + activeTime("IO1") + activeTime("IO2")) /
                               results._acc["SWAP_IN"][StationStats::throughput].R());
 }
 
+SimulationContext::SimulationContext(RandomStream &generator) : generator(&generator)
+{
+    os = std::unique_ptr<OS>(new OS(generator));
+    regPoint = std::unique_ptr<RegenerationPoint>(new RegenerationPoint(os.get(), os.get()));
+}
+
+void SimulationContext::Rebuild()
+{
+    os = std::unique_ptr<OS>(new OS(*generator));
+    regPoint->scheduler = os.get();
+    regPoint->simulator = os.get();
+    results.Reset();
+    results.RestartWarmup();
+}
+
+void SimulationContext::Setup(BaseScenario *scenario)
+{
+    regPoint->Reset();
+    Rebuild();
+    // the scenario resolves its station handles through the regeneration point
+    scenario->Setup(this);
+    // only the stations whose response times are collected pay for tracking them
+    for (auto name : {"CPU", "IO1", "IO2", "SWAP_IN"})
+    {
+        auto station = os->GetStation(name).value();
+        station->TrackResponseTimes();
+        station->OnDeparture([this](BaseStation *s, auto &e) { results.CollectResponse(s); });
+    }
+    // the measures are read as of the regeneration clock, OS::Reset then brings every station to it
+    regPoint->AddAction([this](RegenerationPoint *point) {
+        CollectMeasures();
+        point->scheduler->Reset();
+    });
+    results.tgt.WithRegPoint(regPoint.get());
+    results.tgt.ConnectEntrance(os->GetStation("SWAP_IN").value().get(), false);
+    results.tgt.ConnectLeave(os->GetStation("SWAP_OUT").value().get(), true);
+}
+
+int SimulationContext::RunCycles(int cycles, size_t maxEvents)
+{
+    // counted on the hits, an early stop leaves no action behind on the regeneration point
+    int start = regPoint->hitted();
+    size_t events = 0;
+    while (regPoint->hitted() - start < cycles && events < maxEvents)
+    {
+        int hits = regPoint->hitted();
+        os->Execute();
+        events = regPoint->hitted() == hits ? events + 1 : 0;
+    }
+    return regPoint->hitted() - start;
+}
+
 void SimulationManager::SetupScenario(std::string name)
 {
     BaseScenario *s = nullptr;
@@ -218,33 +354,18 @@ void SimulationManager::SetupScenario(std::string name)
         return;
     }
     _currScenario = s;
-    regPoint->Reset();
-    HReset();
-    s->Setup(this);
-    regPoint->AddAction([this](RegenerationPoint *point) {
-        os->Sync();
-        CollectMeasures();
-        point->scheduler->Reset();
-        os->Sync();
-    });
-    regPoint->scheduler = os.get();
-    regPoint->simulator = os.get();
-    results.tgt.WithRegPoint(regPoint.get());
-    results.tgt.ConnectEntrance(os->GetStation("SWAP_IN").value().get(), false);
-    results.tgt.ConnectLeave(os->GetStation("SWAP_OUT").value().get(), true);
+    Setup(s);
+    shell->SetControllers(os.get(), os.get());
 }
 
 void SimulationManager::HReset()
 {
-    os = std::unique_ptr<OS>(new OS());
+    Rebuild();
     shell->SetControllers(os.get(), os.get());
-    results.Reset();
 }
 
 SimulationManager::SimulationManager()
 {
-    os = std::unique_ptr<OS>(new OS());
-    regPoint = std::unique_ptr<RegenerationPoint>(new RegenerationPoint(os.get(), os.get()));
 }
 
 void SimulationManager::SetupShell(SimulationShell *shell)
@@ -270,6 +391,9 @@ void SimulationManager::SetupShell(SimulationShell *shell)
         "na", [&](SimulationShell *shell, const char *context) { attach(context, shell, true, os.get(), logger); });
     shell->AddCommand("nd", [&](auto s, auto ctx) { attach(ctx, s, true, os.get(), logger); });
     shell->AddCommand("ns", [this](SimulationShell *shell, const char *ctx) { search_states(ctx); });
+    shell->AddCommand("nrep", [this](SimulationShell *shell, const char *ctx) { perform_replications(ctx); });
+    shell->AddCommand("sweep", [this](SimulationShell *shell, const char *ctx) { perform_sweep(ctx); });
+    shell->AddCommand("trace", [this](SimulationShell *shell, const char *ctx) { record_trace(ctx); });
     results.AddShellCommands(shell);
 };
 
@@ -292,6 +416,7 @@ void SimulationManager::CollectSamples(int samples, bool logMeasures, bool logAc
         }
         if (logActualState)
         {
+            LogLocker lock{};
             auto print = [](BaseStation *s) {
                 fmt::println("Station:{},N:{},A:{},C:{}", s->Name(), s->sysClients(), s->arrivals(), s->completions());
             };
@@ -303,14 +428,24 @@ void SimulationManager::CollectSamples(int samples, bool logMeasures, bool logAc
             print(os->GetStation(0).value().get());
         }
     };
-    if (samples == -1)
+    if (samples == -1 && results.estimator == Estimator::BATCH_MEANS)
     {
-        int i = 0;
-        while (results.tgt._mean.confidence().precision() > 0.05 || results.tgt._mean.Count() < 40)
+        // no regeneration point to wait for, the stopper counts blocks of events instead of cycles
+        constexpr int blockEvents = 10000;
+        PrecisionStopper stopper{};
+        for (int block = 0; !stopper.Done(results, block); block++)
         {
-            p(i);
-            i++;
+            for (int i = 0; i < blockEvents; i++)
+                os->Execute();
         }
+        return;
+    }
+    if (samples == -1)
+    {
+        PrecisionStopper stopper{};
+        for (int i = 0; !stopper.Done(results, i); i++)
+            p(i);
+        return;
     }
     for (int i = 0; i < samples; i++)
     {
@@ -338,7 +473,14 @@ void SimulationManager::SearchStates(int iterations, bool logActualState)
 
     std::vector<std::pair<State, int>> hits{};
     bool end = false;
-    auto execFnc = [this, &end, &hits]() {
+    auto delay = os->GetStation(0).value();
+    auto reserve = os->GetStation("RESERVE_STATION").value();
+    auto cpu = os->GetStation("CPU").value();
+    auto io1 = os->GetStation("IO1").value();
+    auto io2 = os->GetStation("IO2").value();
+    auto swapIn = os->GetStation("SWAP_IN").value();
+    auto swapOut = os->GetStation("SWAP_OUT").value();
+    auto execFnc = [&]() {
         regPoint->AddOneTimeAction([&end](auto rs) { end = true; });
         while (!end)
         {
@@ -346,13 +488,13 @@ void SimulationManager::SearchStates(int iterations, bool logActualState)
         }
         end = false;
         State s = {
-            .N_delay = os->GetStation(0).value()->sysClients(),
-            .N_reserve = os->GetStation("RESERVE_STATION").value()->sysClients(),
-            .N_cpu = os->GetStation("CPU").value()->sysClients(),
-            .N_io1 = os->GetStation("IO1").value()->sysClients(),
-            .N_io2 = os->GetStation("IO2").value()->sysClients(),
-            .N_swap = os->GetStation("SWAP_IN").value()->sysClients(),
-            .N_out = os->GetStation("SWAP_OUT").value()->sysClients(),
+            .N_delay = delay->sysClients(),
+            .N_reserve = reserve->sysClients(),
+            .N_cpu = cpu->sysClients(),
+            .N_io1 = io1->sysClients(),
+            .N_io2 = io2->sysClients(),
+            .N_swap = swapIn->sysClients(),
+            .N_out = swapOut->sysClients(),
         };
         for (int i = 0; i < hits.size(); i++)
         {
@@ -365,6 +507,7 @@ void SimulationManager::SearchStates(int iterations, bool logActualState)
         hits.push_back({s, 1});
     };
     auto printarray = [&hits]() {
+        LogLocker lock{};
         for (auto e : hits)
         {
             fmt::println("NDelay:{}, NReserve:{}, NSwap:{}, NCPU:{}, NIO1:{}, NIO2:{},NOUT:{}, hits:{}",
@@ -4,11 +4,17 @@
 #include "Shell/SimulationShell.hpp"
 #include "Station.hpp"
 #include "SystemParameters.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <fmt/core.h>
 #include <fmt/format.h>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 void ConfidenceHits::Accumulate(bool x_in, bool u_in, bool n_in, bool w_in, bool activeTime_in)
@@ -17,7 +23,8 @@ void ConfidenceHits::Accumulate(bool x_in, bool u_in, bool n_in, bool w_in, bool
     utilization_in = u_in;
     meanClients_in = n_in;
     meanWaits_in = w_in;
-    activeTime_in = activeTime_in;
+    this->activeTime_in = activeTime_in;
+    collected++;
     throughput += x_in;
     utilization += u_in;
     meanclients += n_in;
@@ -25,6 +32,24 @@ void ConfidenceHits::Accumulate(bool x_in, bool u_in, bool n_in, bool w_in, bool
     activeTimes += activeTime_in;
 }
 
+void ConfidenceHits::Merge(const ConfidenceHits &other)
+{
+    throughput += other.throughput;
+    utilization += other.utilization;
+    meanwaits += other.meanwaits;
+    meanclients += other.meanclients;
+    activeTimes += other.activeTimes;
+    if (other.collected == 0)
+        return;
+    bool empty = collected == 0;
+    throughput_in = other.throughput_in && (empty || throughput_in);
+    utilization_in = other.utilization_in && (empty || utilization_in);
+    meanClients_in = other.meanClients_in && (empty || meanClients_in);
+    meanWaits_in = other.meanWaits_in && (empty || meanWaits_in);
+    activeTime_in = other.activeTime_in && (empty || activeTime_in);
+    collected += other.collected;
+}
+
 void SimulationResult::CollectResult(int seed)
 {
     if (!mva.inited)
@@ -63,6 +88,7 @@ void SimulationResult::CollectResult(int seed)
 
 SimulationResult::SimulationResult() : _logger("SimulationResults", 1)
 {
+    tgt._batches.WithConfidence(confidence);
 }
 
 void SimulationResult::AddShellCommands(SimulationShell *shell)
@@ -70,6 +96,7 @@ void SimulationResult::AddShellCommands(SimulationShell *shell)
     shell->AddCommand("lsimresults", [this](SimulationShell *shell, const char *context) { LogSimResults(); });
     shell->AddCommand("ltgtstats", [this](SimulationShell *s, auto ctx) {
         s->Log()->Result("{},Expected:{}", tgt._mean, mva.ActiveTimes()[SystemParameters::Parameters().numclients]);
+        s->Log()->Result("{}", tgt._quantiles);
     });
 
     shell->AddCommand("lmeasures", [this](SimulationShell *shell, const char *ctx) {
@@ -91,6 +118,7 @@ void SimulationResult::AddShellCommands(SimulationShell *shell)
         stream >> buffer;
         auto station = std::string(buffer);
         stream >> buffer;
+        LogLocker lock{};
         if (station == "ActiveTime")
         {
             fmt::println("ActiveTime;{:csv};{}", tgt._mean,
@@ -104,6 +132,71 @@ void SimulationResult::AddShellCommands(SimulationShell *shell)
         fmt::println("{};{:csv};{}", station, acc, expected);
     });
     shell->AddCommand("reset_measures", [this](auto s, auto ctx) { Reset(); });
+    shell->AddCommand("estimator", [this](SimulationShell *shell, const char *ctx) {
+        std::string name{};
+        size_t warmup = 0;
+        std::stringstream stream{ctx};
+        stream >> name >> warmup;
+        if (name == "regen")
+            UseEstimator(Estimator::REGENERATIVE, warmup);
+        else if (name == "batch")
+            UseEstimator(Estimator::BATCH_MEANS, warmup);
+        else
+            _logger.Exception("Usage: estimator regen|batch [warmup samples]");
+    });
+    shell->AddCommand("saveresults", [this](SimulationShell *shell, const char *ctx) {
+        std::string file{};
+        std::stringstream stream{ctx};
+        stream >> file;
+        std::string state{};
+        Serialize(state);
+        std::ofstream out{file, std::ios::binary};
+        if (file.empty() || !out.write(state.data(), state.size()))
+            _logger.Exception("Usage: saveresults <file>, cannot write {}", file);
+    });
+    shell->AddCommand("mergeresults", [this](SimulationShell *shell, const char *ctx) {
+        std::string file{};
+        std::stringstream stream{ctx};
+        stream >> file;
+        std::ifstream in{file, std::ios::binary};
+        std::string state{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        std::string_view view{state};
+        SimulationResult other{};
+        if (file.empty() || !other.Deserialize(view))
+        {
+            _logger.Exception("Usage: mergeresults <file>, {} does not hold saved results", file);
+            return;
+        }
+        Merge(other);
+    });
+    shell->AddCommand("spillresponses", [this](SimulationShell *shell, const char *ctx) {
+        std::string station{};
+        std::string file{};
+        std::stringstream stream{ctx};
+        stream >> station >> file;
+        if (station.empty() || file.empty())
+        {
+            _logger.Exception("Usage: spillresponses <CPU|IO1|IO2|SWAP_IN> <file>");
+            return;
+        }
+        auto samples = std::make_unique<BufferedMeasure<>>(station + "_response", "ms", 4096, file);
+        if (!samples->Data().IsSpilling())
+        {
+            _logger.Exception("spillresponses: cannot open {}", file);
+            return;
+        }
+        _spilledResponses[station] = std::move(samples);
+    });
+}
+
+void SimulationResult::UseEstimator(Estimator estimator, size_t warmup)
+{
+    this->estimator = estimator;
+    batchWarmup = warmup;
+    tgt._batches.WithWarmup(warmup);
+    for (auto &[station, stats] : _acc)
+        stats.batchWait.WithWarmup(warmup);
+    Reset();
 }
 
 void SimulationResult::Reset()
@@ -113,20 +206,150 @@ void SimulationResult::Reset()
         v.second.Reset();
     }
     _activeTime.Reset();
+    for (auto &[station, samples] : _spilledResponses)
+        samples->Reset();
     tgt._mean.Reset();
     tgt._acc.Reset();
+    tgt._quantiles.Reset();
+    tgt._batches.Reset();
+}
+
+void SimulationResult::Merge(const SimulationResult &other)
+{
+    for (auto &[name, stats] : other._acc)
+        Stats(name).Merge(stats);
+    for (auto &[name, hits] : other._confidenceHits)
+        _confidenceHits[name].Merge(hits);
+    _activeTime.Merge(other._activeTime);
+    tgt._mean.Merge(other.tgt._mean);
+    tgt._acc.Merge(other.tgt._acc);
+    tgt._quantiles.Merge(other.tgt._quantiles);
+    tgt._batches.Merge(other.tgt._batches);
+    seeds.insert(seeds.end(), other.seeds.begin(), other.seeds.end());
 }
 
-void SimulationResult::Collect(BaseStation *station)
+static void WriteName(std::string &out, const std::string &name)
 {
-    if (tgt._transitory.delta() <= 0.1)
-        _acc[station->Name()].Collect(station);
+    helper::write_state(out, (uint32_t)name.size());
+    out.append(name);
+}
+
+static bool ReadName(std::string_view &in, std::string &name)
+{
+    uint32_t size = 0;
+    if (!helper::read_state(in, size) || in.size() < size)
+        return false;
+    name = std::string{in.substr(0, size)};
+    in.remove_prefix(size);
+    return true;
+}
+
+void SimulationResult::Serialize(std::string &out) const
+{
+    helper::write_state(out, (uint32_t)_acc.size());
+    for (auto &[name, stats] : _acc)
+    {
+        WriteName(out, name);
+        stats.Serialize(out);
+    }
+    helper::write_state(out, (uint32_t)_confidenceHits.size());
+    for (auto &[name, hits] : _confidenceHits)
+    {
+        WriteName(out, name);
+        helper::write_state(out, hits);
+    }
+    _activeTime.Serialize(out);
+    tgt._mean.Serialize(out);
+    tgt._acc.Serialize(out);
+    tgt._quantiles.Serialize(out);
+    tgt._batches.Serialize(out);
+    helper::write_state(out, (uint32_t)seeds.size());
+    for (int seed : seeds)
+        helper::write_state(out, seed);
+}
+
+bool SimulationResult::Deserialize(std::string_view &in)
+{
+    _acc.clear();
+    _confidenceHits.clear();
+    seeds.clear();
+    uint32_t size = 0;
+    std::string name{};
+    bool valid = helper::read_state(in, size);
+    for (uint32_t i = 0; valid && i < size; i++)
+        valid = ReadName(in, name) && _acc[name].Deserialize(in);
+    valid = valid && helper::read_state(in, size);
+    for (uint32_t i = 0; valid && i < size; i++)
+        valid = ReadName(in, name) && helper::read_state(in, _confidenceHits[name]);
+    valid = valid && _activeTime.Deserialize(in) && tgt._mean.Deserialize(in) && tgt._acc.Deserialize(in) &&
+            tgt._quantiles.Deserialize(in) && tgt._batches.Deserialize(in) && helper::read_state(in, size);
+    for (uint32_t i = 0; valid && i < size; i++)
+        valid = helper::read_state(in, seeds.emplace_back());
+    return valid;
+}
+
+void SimulationResult::Collect(const BaseStation &station, const StationCounters &counters, double clock)
+{
+    Stats(station.Name()).Collect(counters, station.responseTimes(), clock);
+}
+
+StationStats &SimulationResult::Stats(const std::string &station)
+{
+    auto [itr, inserted] = _acc.try_emplace(station);
+    if (inserted)
+        itr->second.batchWait.WithWarmup(batchWarmup);
+    return itr->second;
 }
 
 void SimulationResult::CollectActiveTime(double value)
 {
-    if (tgt._transitory.delta() <= 0.1)
-        _activeTime.Accumulate(value);
+    if (IsTransitoryPeriod())
+        return;
+    // a cycle without completions gives no active time, one NaN would poison the mean for the rest of the run
+    if (!std::isfinite(value))
+    {
+        _logger.Exception("Active time {} discarded", value);
+        return;
+    }
+    _activeTime.Accumulate(value);
+}
+
+void SimulationResult::CollectResponse(BaseStation *station)
+{
+    double response = station->lastResponseTime();
+    if (std::isnan(response))
+        return;
+    if (estimator == Estimator::BATCH_MEANS)
+        Stats(station->Name()).batchWait.Accumulate(response);
+    if (!_spilledResponses.empty())
+    {
+        auto itr = _spilledResponses.find(station->Name());
+        if (itr != _spilledResponses.end())
+            itr->second->Accumulate(response);
+    }
+}
+
+// ratio between the samples an interval needs to reach the required precision and the samples it has
+static double PrecisionNeeds(double precision)
+{
+    double ratio = precision / SimulationResult::requiredPrecision;
+    return std::isnan(ratio) ? INFINITY : ratio * ratio;
+}
+
+static double PrecisionNeeds(const CovariatedMeasure &measure)
+{
+    if (measure.Count() < 2)
+        return INFINITY;
+    return (double)measure.SampleNeedsForPrecision(SimulationResult::requiredPrecision) / measure.Count();
+}
+
+double SimulationResult::TargetNeeds(const std::string &target)
+{
+    if (target != "ActiveTime")
+        return Stats(target).Needs(estimator);
+    if (estimator == Estimator::BATCH_MEANS)
+        return PrecisionNeeds(tgt._batches.confidence().precision());
+    return PrecisionNeeds(tgt._mean);
 }
 
 bool SimulationResult::PrecisionReached()
@@ -134,17 +357,11 @@ bool SimulationResult::PrecisionReached()
     auto logger = SimulationShell::Instance().Log();
     for (std::string tg : _precisionTargets)
     {
-        if (tg == "ActiveTime" && tgt._mean.confidence().precision() > requiredPrecision)
+        if (TargetNeeds(tg) > 1.0)
         {
             logger->Information("Target:{} not reached precision", tg);
             return false;
         }
-        else if (!_acc[tg].Ready())
-        {
-            logger->Information("Target:{} not reached precision", tg);
-
-            return false;
-        }
     }
     logger->Information("All target reached required precision {} ", requiredPrecision);
     return true;
@@ -162,7 +379,21 @@ void SimulationResult::LogSimResults()
 
 bool SimulationResult::IsTransitoryPeriod()
 {
-    return this->tgt._transitory.delta() > 0.1;
+    if (tgt._transitory.Transitory())
+        return true;
+    for (auto &[name, stats] : _acc)
+    {
+        if (stats.warmup.Transitory())
+            return true;
+    }
+    return false;
+}
+
+void SimulationResult::RestartWarmup()
+{
+    tgt.RestartWarmup();
+    for (auto &[name, stats] : _acc)
+        stats.RestartWarmup();
 }
 
 void SimulationResult::LogResult(std::string name)
@@ -178,6 +409,9 @@ void SimulationResult::LogResult(std::string name)
                     s.first, &s.second[(StationStats::MeasureType)i].WithConfidence(SimulationResult::confidence));
                 result += fmt::format("{}, Expected Value:{}\n", s.second[(StationStats::MeasureType)i], expected);
             }
+            result += fmt::format("{}\n", s.second.responseTime);
+            if (estimator == Estimator::BATCH_MEANS)
+                result += fmt::format("{}\n", s.second.batchWait);
             SimulationShell::Instance().Log()->Result("Station:{}\n{}", s.first, result);
         }
 
@@ -185,6 +419,11 @@ void SimulationResult::LogResult(std::string name)
                                                   tgt._mean.WithConfidence(SimulationResult::confidence),
                                                   mva.ActiveTimes()[SystemParameters::Parameters().numclients]);
     }
+    else if (name == "ActiveTime" && estimator == Estimator::BATCH_MEANS)
+    {
+        SimulationShell::Instance().Log()->Result("{},Expected:{}", tgt._batches,
+                                                  mva.ActiveTimes()[SystemParameters::Parameters().numclients]);
+    }
     else if (name == "ActiveTime")
     {
         SimulationShell::Instance().Log()->Result("{},Expected:{}", tgt._mean,
@@ -202,6 +441,9 @@ void SimulationResult::LogResult(std::string name)
                 fmt::format("{}, Expected Value:{}\n",
                             acc[(StationStats::MeasureType)i].WithConfidence(SimulationResult::confidence), expected);
         }
+        result += fmt::format("{}\n", acc.responseTime);
+        if (estimator == Estimator::BATCH_MEANS)
+            result += fmt::format("{}\n", acc.batchWait);
         SimulationShell::Instance().Log()->Result("Station:{}\n{}", name, result);
     }
 }
@@ -224,26 +466,58 @@ auto format_as(StationStats stats)
     return result;
 }
 
-bool StationStats::Ready()
+double StationStats::Needs(Estimator estimator)
 {
-    for (int i = 0; i < size; i++)
+    if (estimator == Estimator::BATCH_MEANS)
+        return PrecisionNeeds(batchWait.confidence().precision());
+    double needs = 0.0;
+    // utilization is not collected, throughput only feeds the active time
+    for (int i = meancustomer; i < size; i++)
+        needs = std::max(needs, PrecisionNeeds((*this)[(MeasureType)i]));
+    return needs;
+}
+
+bool StationStats::Ready(Estimator estimator)
+{
+    return Needs(estimator) <= 1.0;
+}
+
+void StationStats::Collect(const StationCounters &counters, const QuantileMeasure *responseTimes, double clock)
+{
+    double areaN = counters.population.Area(clock);
+    double observation = counters.population.Observation(clock);
+    if (!warmup.Transitory())
+        CollectCycle(areaN, counters.completions, observation);
+    else
     {
-        auto a = (*this)[(MeasureType)i];
-        if (a.confidence().precision() > SimulationResult::requiredPrecision || a.Count() < 2)
-        {
-            return false;
-        }
+        if (observation <= 0)
+            return;
+        pending.push_back({areaN, (double)counters.completions, observation});
+        warmup.Push(areaN / observation);
+        if (warmup.Transitory())
+            return;
+        // the response times of the replayed cycles are gone, the sketch starts with this one
+        for (size_t i = std::min(warmup.TruncationPoint(), pending.size()); i < pending.size(); i++)
+            CollectCycle(pending[i][0], pending[i][1], pending[i][2]);
+        pending = {};
     }
-    return true;
+    if (responseTimes != nullptr)
+        responseTime.Merge(*responseTimes);
 }
 
-void StationStats::Collect(BaseStation *station)
+void StationStats::CollectCycle(double areaN, double completions, double observation)
 {
     auto &self = *this;
-    // self[throughput](station->completions(), station->clock() - self[throughput].times());
     // self[utilization](station->busyTime(), station->clock() - self[utilization].times());
-    self[meanwait].WithConfidence(0.90)(station->areaN(), station->completions());
-    self[meancustomer].WithConfidence(0.90)(station->areaN(), station->observation());
+    self[throughput].WithConfidence(0.90)(completions, observation);
+    self[meanwait].WithConfidence(0.90)(areaN, completions);
+    self[meancustomer].WithConfidence(0.90)(areaN, observation);
+}
+
+void StationStats::RestartWarmup()
+{
+    warmup.Reset();
+    pending = {};
 }
 
 StationStats::StationStats()
@@ -252,6 +526,7 @@ StationStats::StationStats()
     _acc[utilization] = CovariatedMeasure{"utilization", ""}.WithConfidence(SimulationResult::confidence);
     _acc[meancustomer] = CovariatedMeasure{"meanclients", ""}.WithConfidence(SimulationResult::confidence);
     _acc[meanwait] = CovariatedMeasure{"meanwaits", "ms"}.WithConfidence(SimulationResult::confidence);
+    batchWait.WithConfidence(SimulationResult::confidence);
 }
 
 CovariatedMeasure &StationStats::operator[](StationStats::MeasureType measure)
@@ -272,6 +547,32 @@ CovariatedMeasure &StationStats::operator[](StationStats::MeasureType measure)
     }
 }
 
+void StationStats::Merge(const StationStats &other)
+{
+    for (int i = 0; i < size; i++)
+        _acc[i].Merge(other._acc[i]);
+    responseTime.Merge(other.responseTime);
+    batchWait.Merge(other.batchWait);
+}
+
+void StationStats::Serialize(std::string &out) const
+{
+    for (int i = 0; i < size; i++)
+        _acc[i].Serialize(out);
+    responseTime.Serialize(out);
+    batchWait.Serialize(out);
+}
+
+bool StationStats::Deserialize(std::string_view &in)
+{
+    for (int i = 0; i < size; i++)
+    {
+        if (!_acc[i].Deserialize(in))
+            return false;
+    }
+    return responseTime.Deserialize(in) && batchWait.Deserialize(in);
+}
+
 void StationStats::Reset()
 {
     for (int i = 0; i < size; i++)
@@ -279,4 +580,6 @@ void StationStats::Reset()
         _acc[i].WithConfidence(SimulationResult::confidence);
         _acc[i].Reset();
     }
+    responseTime.Reset();
+    batchWait.Reset();
 }
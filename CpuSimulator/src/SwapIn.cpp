@@ -9,9 +9,13 @@
 
 SwapIn::SwapIn(IScheduler *scheduler)
     : FCFSStation(scheduler, "SWAP_IN", Stations::SWAP_IN),
-      _serviceTime(
-          VariableStream(6, [](auto &rng) { return Exponential(SystemParameters::Parameters().averageSwapIn); }))
+      _serviceTime(VariableStream(scheduler->Generator(), 6, [](auto &rng) {
+          return Exponential(SystemParameters::Parameters().averageSwapIn, rng);
+      }))
 {
+    // stream 6 has no other consumer, so the buffered draws keep the sequence
+    _serviceTime.WithBuffer(
+        64, [](auto out, auto &rng) { Exponential(SystemParameters::Parameters().averageSwapIn, out, rng); });
 }
 
 void SwapIn::ProcessArrival(Event &evt)
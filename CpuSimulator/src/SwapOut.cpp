@@ -16,16 +16,16 @@ void SwapOut::ProcessArrival(Event &evt)
 
 void SwapOut::ProcessDeparture(Event &evt)
 {
-    static Router router(2, {0.6, 0.4}, {RESERVE_STATION, 0});
     Station::ProcessDeparture(evt);
     evt.Type = EventType::ARRIVAL;
     evt.OccurTime = _clock;
-    evt.Station = router();
+    evt.Station = _router();
     _logger.Transfer("Swapping out Process:{} to {}", evt, evt.Station == RESERVE_STATION ? "Reserve" : "DelayStation");
     _scheduler->Schedule(evt);
 }
 
-SwapOut::SwapOut(IScheduler *scheduler) : Station("SWAP_OUT", Stations::SWAP_OUT)
+SwapOut::SwapOut(IScheduler *scheduler)
+    : Station("SWAP_OUT", Stations::SWAP_OUT), _router(scheduler->Generator(), 2, {0.6, 0.4}, {RESERVE_STATION, 0})
 {
     _scheduler = scheduler;
 }
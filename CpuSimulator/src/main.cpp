@@ -49,4 +49,6 @@ int main(int argc, char **argv)
             shell.ExecuteCommand(cmd.c_str());
         }
     }
+    LogEngine::Instance()->Flush();
+    LogEngine::DestroyInstance();
 }
@@ -1,6 +1,18 @@
 #pragma once
 #include "Scheduler.hpp"
+#include "SystemParameters.hpp"
 
 struct MockScheduler : public Scheduler
 {
-};
\ No newline at end of file
+};
+
+// restores the shared parameters on destruction, so a test that changes them cannot change the results of the next ones
+struct ParametersGuard
+{
+    SystemParameters saved = SystemParameters::Parameters();
+
+    ~ParametersGuard()
+    {
+        SystemParameters::Parameters() = saved;
+    }
+};
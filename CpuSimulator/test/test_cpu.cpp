@@ -10,6 +10,7 @@
 #include "Scheduler.hpp"
 #include "Station.hpp"
 #include "SystemParameters.hpp"
+#include "TestEnv.hpp"
 #include "rngs.hpp"
 #include <fmt/core.h>
 #include <gtest/gtest.h>
@@ -31,6 +32,7 @@ TEST(TestCpu, test_arrival)
 TEST(TestCpu, test_flooding)
 {
     Scheduler sched{"scheduler"};
+    ParametersGuard guard{};
     auto &params = SystemParameters::Parameters();
     auto cpu = new Cpu(&sched);
     auto io1 = new MockStation(Stations::IO_1);
@@ -58,6 +60,7 @@ TEST(TestCpu, test_flooding)
 TEST(TestIO, test_arrival)
 {
     RandomStream::Global().PlantSeeds(123456789);
+    ParametersGuard guard{};
     Scheduler sched{"scheduler"};
     auto cpu = new MockStation(CPU);
     auto io1 = new MockStation(Stations::IO_1);
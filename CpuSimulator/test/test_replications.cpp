@@ -0,0 +1,245 @@
+#include "LogEngine.hpp"
+#include "OperativeSystem.hpp"
+#include "ParameterSweep.hpp"
+#include "PrecisionStopper.hpp"
+#include "ReplicationRunner.hpp"
+#include "SimulationEnv.hpp"
+#include "SimulationResult.hpp"
+#include "TestEnv.hpp"
+#include "rngs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+static BaseScenario *FindScenario(std::string name)
+{
+    auto &scenarios = SimulationManager::Instance()._scenarios;
+    auto itr = std::find_if(scenarios.begin(), scenarios.end(), [&name](auto s) { return s->name == name; });
+    return itr == scenarios.end() ? nullptr : *itr;
+}
+
+TEST(TestReplications, test_threads_do_not_change_results)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    auto scenario = FindScenario("Default");
+    ASSERT_NE(nullptr, scenario);
+    // the scenario setup writes the shared parameters
+    ParametersGuard guard{};
+    SimulationResult serial{};
+    SimulationResult parallel{};
+    ReplicationRunner single{scenario, 2, 1};
+    single.Run(1);
+    single.MergeInto(serial);
+    ReplicationRunner pool{scenario, 2, 2};
+    pool.Run(1);
+    pool.MergeInto(parallel);
+    for (int r = 0; r < single.Replications(); r++)
+    {
+        ASSERT_GT(single[r].os->GetClock(), 0);
+        ASSERT_EQ(single[r].os->GetClock(), pool[r].os->GetClock());
+    }
+    ASSERT_NE(single[0].os->GetClock(), single[1].os->GetClock());
+    ASSERT_EQ(serial.tgt._mean.Count(), parallel.tgt._mean.Count());
+    for (auto &[name, stats] : serial._acc)
+        ASSERT_EQ(stats[StationStats::meanwait].Count(), parallel._acc[name][StationStats::meanwait].Count());
+}
+
+TEST(TestReplications, test_merge_saved_results)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    auto scenario = FindScenario("Default");
+    ASSERT_NE(nullptr, scenario);
+    ParametersGuard guard{};
+    // a slower IO2 holds the 9 customers of the regeneration state of Default more often, the cycles stay short
+    SystemParameters::Parameters().averageIO2 = 360;
+    ReplicationRunner runner{scenario, 3, 3};
+    // enough cycles for every detector to leave the transitory period, so the measures hold samples
+    ASSERT_TRUE(runner.Run(60));
+    SimulationResult direct{};
+    runner.MergeInto(direct);
+    // every replica ships only the state of its measures, merged in reverse order
+    SimulationResult reduced{};
+    for (int r = runner.Replications() - 1; r >= 0; r--)
+    {
+        std::string state{};
+        runner[r].results.Serialize(state);
+        std::string_view view{state};
+        SimulationResult shipped{};
+        ASSERT_TRUE(shipped.Deserialize(view));
+        ASSERT_TRUE(view.empty());
+        reduced.Merge(shipped);
+    }
+    ASSERT_EQ(direct._acc.size(), reduced._acc.size());
+    for (auto &[name, stats] : direct._acc)
+    {
+        for (int i = 0; i < StationStats::size; i++)
+        {
+            auto &expected = stats[(StationStats::MeasureType)i];
+            auto &merged = reduced._acc[name][(StationStats::MeasureType)i];
+            ASSERT_EQ(expected.Count(), merged.Count());
+            if (expected.Count() > 1)
+            {
+                ASSERT_DOUBLE_EQ(expected.R(), merged.R());
+                // the residuals are a difference of comoments, the order of the merges shows in the last digits
+                ASSERT_NEAR(expected.variance(), merged.variance(), 1e-6 * std::abs(expected.variance()));
+            }
+        }
+    }
+    ASSERT_GT(direct.tgt._mean.Count(), 0);
+    ASSERT_EQ(direct.tgt._mean.Count(), reduced.tgt._mean.Count());
+    ASSERT_DOUBLE_EQ(direct.tgt._mean.R(), reduced.tgt._mean.R());
+}
+
+TEST(TestReplications, test_merge_confidence_hits)
+{
+    ConfidenceHits hit{};
+    hit.Accumulate(true, true, true, true, true);
+    ConfidenceHits miss{};
+    miss.Accumulate(false, true, false, true, false);
+    ConfidenceHits forward{};
+    forward.Merge(hit);
+    forward.Merge(miss);
+    ConfidenceHits backward{};
+    backward.Merge(miss);
+    backward.Merge(hit);
+    for (auto &merged : {forward, backward})
+    {
+        ASSERT_EQ(2, merged.collected);
+        ASSERT_EQ(1, merged.throughput);
+        ASSERT_FALSE(merged.throughput_in);
+        ASSERT_TRUE(merged.utilization_in);
+        ASSERT_FALSE(merged.activeTime_in);
+    }
+}
+
+TEST(TestReplications, test_replica_streams)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    auto scenario = FindScenario("Default");
+    ASSERT_NE(nullptr, scenario);
+    // the scenario setup writes the shared parameters
+    ParametersGuard guard{};
+    // the Lehmer blocks are too small to split among replications
+    ReplicationRunner single{scenario, 1, 1, DEFAULT, RandomEngine::LEHMER};
+    ASSERT_EQ(RandomEngine::LEHMER, single.Engine());
+    ReplicationRunner split{scenario, 4, 1, DEFAULT, RandomEngine::LEHMER};
+    ASSERT_EQ(RandomEngine::XOSHIRO256PP, split.Engine());
+    ASSERT_EQ(RandomEngine::XOSHIRO256PP, split[3].generator->Engine());
+    ASSERT_NE(split[0].generator->Random(), split[1].generator->Random());
+}
+
+TEST(TestReplications, test_generator_per_simulation)
+{
+    RandomStream first{};
+    RandomStream second{};
+    first.PlantSeeds(DEFAULT);
+    second.PlantSeeds(DEFAULT);
+    OS a{first};
+    OS b{second};
+    a.Initialize();
+    b.Initialize();
+    for (int i = 0; i < 10000; i++)
+    {
+        a.Execute();
+        b.Execute();
+        ASSERT_EQ(a.GetClock(), b.GetClock());
+    }
+}
+
+TEST(TestReplications, test_precision_stopper)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    auto scenario = FindScenario("Default");
+    ASSERT_NE(nullptr, scenario);
+    // the scenario setup writes the shared parameters
+    ParametersGuard guard{};
+    double required = SimulationResult::requiredPrecision;
+    SimulationResult::requiredPrecision = 0.2;
+    SimulationContext context{};
+    context.Setup(scenario);
+    context.os->Initialize();
+    PrecisionStopper stopper{};
+    int cycles = 0;
+    while (!stopper.Done(context.results, cycles))
+    {
+        context.RunCycles(1);
+        cycles++;
+    }
+    double needs = 0.0;
+    for (auto &target : context.results._precisionTargets)
+        needs = std::max(needs, context.results.TargetNeeds(target));
+    SimulationResult::requiredPrecision = required;
+    ASSERT_GE(cycles, 40);
+    ASSERT_LE(stopper.Needs(), 1.0);
+    ASSERT_LE(needs, 1.0);
+    // every check moves the next one at least 5% of the cycles ahead
+    ASSERT_LE(stopper.Checks(), 1 + std::log(cycles / 40.0) / std::log(1.05) + 1);
+}
+
+TEST(TestReplications, test_sweep_grid)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    ParameterSweep sweep{FindScenario("Default")};
+    std::stringstream spec{"# capacity planning\nnumclients, 10, 20\ncpuQuantum,1:3:1\n\n"};
+    ASSERT_TRUE(sweep.Parse(spec));
+    ASSERT_EQ(6, sweep.Points());
+    ASSERT_EQ((std::vector<double>{10, 1}), sweep.Point(0));
+    ASSERT_EQ((std::vector<double>{10, 3}), sweep.Point(2));
+    ASSERT_EQ((std::vector<double>{20, 3}), sweep.Point(5));
+    std::stringstream unknown{"quantum,1,2"};
+    ASSERT_FALSE(sweep.Parse(unknown));
+    std::stringstream range{"cpuQuantum,3:1:1"};
+    ASSERT_FALSE(sweep.Parse(range));
+}
+
+TEST(TestReplications, test_sweep_points_are_isolated)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    auto scenario = FindScenario("Default");
+    ASSERT_NE(nullptr, scenario);
+    int numclients = SystemParameters::Parameters().numclients;
+    ParameterSweep serial{scenario, 1};
+    ParameterSweep parallel{scenario, 4};
+    // every point keeps the 20 customers the regeneration state of Default needs 19 of, and an IO2 slow enough to
+    // hold its 9; the cycles outlast the transitory period so the rows hold samples
+    for (auto sweep : {&serial, &parallel})
+    {
+        ASSERT_TRUE(sweep->Axis("cpuQuantum", {2.7, 5}));
+        ASSERT_TRUE(sweep->Axis("averageIO2", {270, 360}));
+        sweep->Run(200);
+    }
+    // the points never touch the shared parameters
+    ASSERT_EQ(numclients, SystemParameters::Parameters().numclients);
+    ASSERT_EQ(4, parallel.Rows().size());
+    for (size_t p = 0; p < parallel.Rows().size(); p++)
+    {
+        ASSERT_EQ(parallel.Point(p), parallel.Rows()[p].parameters);
+        ASSERT_EQ(200, parallel.Rows()[p].cycles);
+        ASSERT_FALSE(std::isnan(parallel.Rows()[p].measures.back()));
+        ASSERT_EQ(serial.Rows()[p].measures, parallel.Rows()[p].measures);
+    }
+    ASSERT_NE(parallel.Rows()[0].measures, parallel.Rows()[3].measures);
+}
+
+TEST(TestReplications, test_sweep_skips_points_that_cannot_regenerate)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    ParameterSweep sweep{FindScenario("Default"), 1};
+    ASSERT_TRUE(sweep.Axis("numclients", {10, 20}));
+    sweep.Run(2);
+    ASSERT_EQ(2, sweep.Rows().size());
+    ASSERT_EQ(0, sweep.Rows()[0].cycles);
+    for (double measure : sweep.Rows()[0].measures)
+        ASSERT_TRUE(std::isnan(measure));
+    ASSERT_EQ(2, sweep.Rows()[1].cycles);
+}
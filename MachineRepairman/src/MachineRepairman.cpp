@@ -14,12 +14,12 @@
 MachineRepairman::MachineRepairman() : Scheduler("Scheduler")
 {
     auto delay_station = new DelayStation(this, "delay_station", [this]() {
-        static VariableStream delay{1, [](auto rand) { return Exponential(400); }};
+        static VariableStream delay{1, [](auto &rand) { return Exponential(400, rand); }};
         return delay();
     },[](){return 10;});
 
     delay_station->OnDeparture([this](auto s, Event &evt) {
-        static VariableStream repairTime(2, [](auto rand) { return Exponential(15); });
+        static VariableStream repairTime(2, [](auto &rand) { return Exponential(15, rand); });
         evt.ServiceTime = repairTime();
         evt.Station = 1;
         evt.Type = ARRIVAL;
@@ -41,16 +41,18 @@ MachineRepairman::MachineRepairman() : Scheduler("Scheduler")
 
 void MachineRepairman::Initialize()
 {
+    static const EventName maintenance{"MAINTENANCE"};
+    static const EventName end{"END"};
     (*this)["delay_station"]->get()->Initialize();
-    Schedule(Event("MAINTENANCE", MAINTENANCE, 0, _nominalWorkshift, _nominalRests, 0, 1));
-    Schedule(Event("END", END, 0, _nominalWorkshift, 0, 0, -1));
+    Schedule(Event(maintenance, MAINTENANCE, 0, _nominalWorkshift, _nominalRests, 0, 1));
+    Schedule(Event(end, END, 0, _nominalWorkshift, 0, 0, -1));
 }
 
 void MachineRepairman::Execute()
 {
     while (!_end)
     {
-        auto inProcess = _eventList.Dequeue();
+        auto inProcess = _eventList->Dequeue();
         Process(inProcess);
         _clock = inProcess.OccurTime;
         Route(inProcess);
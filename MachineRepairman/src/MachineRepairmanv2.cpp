@@ -17,7 +17,7 @@ MachineRepairmanv2::MachineRepairmanv2() : Scheduler("Scheduler")
     auto delay_station = new DelayStation(
         this, "delay_station",
         []() {
-            static VariableStream delay(1, [](auto rng) { return Exponential(3000); });
+            static VariableStream delay(1, [](auto &rng) { return Exponential(3000, rng); });
             return delay();
         },
         [] { return 10; });
@@ -34,7 +34,7 @@ MachineRepairmanv2::MachineRepairmanv2() : Scheduler("Scheduler")
     srepstation->OnArrival([](auto s, Event &evt) {
         if (evt.SubType == MAINTENANCE)
             return;
-        static VariableStream repair_time(3, [evt](auto rng) { return Exponential(40); });
+        static VariableStream repair_time(3, [evt](auto &rng) { return Exponential(40, rng); });
         evt.ServiceTime = repair_time();
     });
 
@@ -50,7 +50,7 @@ MachineRepairmanv2::MachineRepairmanv2() : Scheduler("Scheduler")
 
     auto lrepstation = new RepairStation(this, "long_repair", 2);
     lrepstation->OnArrival([](auto s, Event &evt) {
-        static VariableStream longRepair{4, [](auto rng) { return Exponential(960); }};
+        static VariableStream longRepair{4, [](auto &rng) { return Exponential(960, rng); }};
         evt.ServiceTime = longRepair();
     });
     lrepstation->OnDeparture([this](auto s, Event &evt) {
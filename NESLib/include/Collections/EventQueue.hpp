@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Collections/LinkedList.hpp"
+#include "Event.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class EventQueueType : int
+{
+    SORTED_LIST,
+    BINARY_HEAP,
+    PAIRING_HEAP,
+    CALENDAR
+};
+
+/**
+ * @brief Pending event set of a scheduler.
+ * @note Events leave in OccurTime order, events with the same OccurTime leave in insertion order
+ */
+class EventQueue
+{
+  protected:
+    struct Entry
+    {
+        Event event;
+        uint64_t sequence;
+
+        bool operator<(const Entry &oth) const
+        {
+            return event.OccurTime < oth.event.OccurTime ||
+                   (event.OccurTime == oth.event.OccurTime && sequence < oth.sequence);
+        }
+    };
+
+    uint64_t _sequence = 0;
+
+    Entry MakeEntry(const Event &event)
+    {
+        return Entry{event, _sequence++};
+    }
+
+  public:
+    virtual void Insert(const Event &event) = 0;
+    virtual Event Dequeue() = 0;
+    virtual const Event &Peek() const = 0;
+    virtual size_t Count() const = 0;
+    virtual void Clear() = 0;
+    virtual std::vector<Event> Ordered() const = 0;
+    virtual EventQueueType Type() const = 0;
+    virtual ~EventQueue() = default;
+
+    static std::unique_ptr<EventQueue> Create(EventQueueType type);
+};
+
+// the original future event list, O(n) insertion
+class SortedListQueue : public EventQueue
+{
+  private:
+    DoubleLinkedList<Event, PooledNodeAllocator<Event>> _list{};
+
+  public:
+    void Insert(const Event &event) override;
+    Event Dequeue() override;
+    const Event &Peek() const override;
+    size_t Count() const override
+    {
+        return _list.Count();
+    }
+    void Clear() override;
+    std::vector<Event> Ordered() const override;
+    EventQueueType Type() const override
+    {
+        return EventQueueType::SORTED_LIST;
+    }
+    ~SortedListQueue();
+};
+
+class BinaryHeapQueue : public EventQueue
+{
+  private:
+    std::vector<Entry> _heap{};
+
+  public:
+    void Insert(const Event &event) override;
+    Event Dequeue() override;
+    const Event &Peek() const override;
+    size_t Count() const override
+    {
+        return _heap.size();
+    }
+    void Clear() override;
+    std::vector<Event> Ordered() const override;
+    EventQueueType Type() const override
+    {
+        return EventQueueType::BINARY_HEAP;
+    }
+};
+
+// nodes live in a vector and are recycled through a free list, so a warm heap does not allocate
+class PairingHeapQueue : public EventQueue
+{
+  private:
+    static constexpr int NIL = -1;
+    struct PNode
+    {
+        Entry entry;
+        int child;
+        int sibling;
+    };
+    std::vector<PNode> _nodes{};
+    std::vector<int> _free{};
+    std::vector<int> _pairs{};
+    int _root = NIL;
+    size_t _count = 0;
+
+    int Meld(int a, int b);
+    int MergePairs(int first);
+
+  public:
+    void Insert(const Event &event) override;
+    Event Dequeue() override;
+    const Event &Peek() const override;
+    size_t Count() const override
+    {
+        return _count;
+    }
+    void Clear() override;
+    std::vector<Event> Ordered() const override;
+    EventQueueType Type() const override
+    {
+        return EventQueueType::PAIRING_HEAP;
+    }
+};
+
+// Brown's calendar queue, buckets are kept sorted with the earliest entry at the back
+class CalendarQueue : public EventQueue
+{
+  private:
+    static constexpr size_t MIN_BUCKETS = 2;
+    struct Slot
+    {
+        Entry entry;
+        long long year; // absolute bucket index floor(OccurTime / width)
+    };
+    std::vector<std::vector<Slot>> _buckets;
+    std::vector<Slot> _scratch{};
+    double _width = 1.0;
+    size_t _count = 0;
+    mutable long long _current = 0;
+
+    long long Year(double time) const;
+    size_t BucketOf(long long year) const;
+    void Place(const Slot &slot);
+    size_t Locate() const;
+    void Resize(size_t buckets);
+    double EstimateWidth();
+
+  public:
+    CalendarQueue();
+    void Insert(const Event &event) override;
+    Event Dequeue() override;
+    const Event &Peek() const override;
+    size_t Count() const override
+    {
+        return _count;
+    }
+    void Clear() override;
+    std::vector<Event> Ordered() const override;
+    EventQueueType Type() const override
+    {
+        return EventQueueType::CALENDAR;
+    }
+    double Width() const
+    {
+        return _width;
+    }
+    size_t Buckets() const
+    {
+        return _buckets.size();
+    }
+};
+
+template <> struct fmt::formatter<EventQueue> : formatter<string_view>
+{
+    auto format(const EventQueue &queue, format_context &ctx) const -> format_context::iterator
+    {
+        if (queue.Count() == 0)
+        {
+            return fmt::format_to(ctx.out(), "[EMPTY]");
+        }
+        auto events = queue.Ordered();
+        std::string result = "";
+        for (size_t i = 0; i < events.size() - 1; i++)
+            result += fmt::format("[{}]->", events[i]);
+        result += fmt::format("[{}]", events.back());
+        return fmt::format_to(ctx.out(), "{}", result);
+    }
+};
@@ -4,6 +4,7 @@
 #include "Event.hpp"
 #include "LogEngine.hpp"
 #include "Node.hpp"
+#include "NodePool.hpp"
 #include <FormatParser.hpp>
 #include <concepts>
 #include <cstddef>
@@ -18,7 +19,7 @@
 #include <string>
 #include <type_traits>
 
-template <class T>
+template <class T, class Allocator = HeapNodeAllocator<T>>
     requires Comparable<T>
 class DoubleLinkedList
 {
@@ -26,7 +27,9 @@ class DoubleLinkedList
     Node<T> *_begin = nullptr;
     Node<T> *_end = nullptr;
     size_t _count = 0;
-    static int _refcount;
+    // shared by a list and its shallow copies, the last one alive releases the nodes
+    std::shared_ptr<const bool> _owners = std::make_shared<const bool>();
+    Allocator _allocator{};
 
   public:
     NodeIterator<T> begin() const
@@ -46,27 +49,29 @@ class DoubleLinkedList
 
     DoubleLinkedList()
     {
-        _refcount++;
     }
 
-    DoubleLinkedList(const DoubleLinkedList &ref)
+    DoubleLinkedList(Allocator allocator) : _allocator(allocator)
+    {
+    }
+
+    DoubleLinkedList(const DoubleLinkedList &ref) : _owners(ref._owners), _allocator(ref._allocator)
     {
-        _refcount++;
         this->_begin = ref._begin;
         this->_end = ref._end;
         this->_count = ref.Count();
     }
 
-    void Push(T val);
+    void Push(const T &val);
     T Pull();
-    void Enqueue(T val);
+    void Enqueue(const T &val);
     T Dequeue();
-    void Insert(T val, int index);
-    void Insert(T val, std::function<bool(const T &, const T &)> comparer);
+    void Insert(const T &val, int index);
+    void Insert(const T &val, std::function<bool(const T &, const T &)> comparer);
     void Clear();
-    int IndexOf(T val);
-    bool Contains(T val);
-    DoubleLinkedList<T> Take(std::function<bool(const T &)> predicate);
+    int IndexOf(const T &val);
+    bool Contains(const T &val);
+    DoubleLinkedList<T, Allocator> Take(std::function<bool(const T &)> predicate);
     std::string ToString();
     ~DoubleLinkedList();
 
@@ -96,16 +101,16 @@ class DoubleLinkedList
     }
 };
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-bool DoubleLinkedList<T>::Contains(T val)
+bool DoubleLinkedList<T, Allocator>::Contains(const T &val)
 {
     return IndexOf(val) != -1;
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-int DoubleLinkedList<T>::IndexOf(T val)
+int DoubleLinkedList<T, Allocator>::IndexOf(const T &val)
 {
     auto itr = begin();
     int p = 0;
@@ -118,11 +123,11 @@ int DoubleLinkedList<T>::IndexOf(T val)
     return -1;
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-void DoubleLinkedList<T>::Push(T val)
+void DoubleLinkedList<T, Allocator>::Push(const T &val)
 {
-    Node<T> *new_node = new Node<T>(val);
+    Node<T> *new_node = _allocator.Acquire(val);
     if (_begin != nullptr)
         *_begin << *new_node;
     if (_end == nullptr)
@@ -131,9 +136,9 @@ void DoubleLinkedList<T>::Push(T val)
     _count++;
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-T DoubleLinkedList<T>::Pull()
+T DoubleLinkedList<T, Allocator>::Pull()
 {
     if (_begin == nullptr)
         panic("Tryed to pull from the list but is empty");
@@ -153,15 +158,15 @@ T DoubleLinkedList<T>::Pull()
     _count--;
     res->_next = nullptr;
     res->_previous = nullptr;
-    delete res;
+    _allocator.Release(res);
     return val;
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-inline void DoubleLinkedList<T>::Enqueue(T val)
+inline void DoubleLinkedList<T, Allocator>::Enqueue(const T &val)
 {
-    Node<T> *newNode = new Node<T>(val);
+    Node<T> *newNode = _allocator.Acquire(val);
     if (_begin == nullptr)
     {
         _begin = newNode;
@@ -177,16 +182,16 @@ inline void DoubleLinkedList<T>::Enqueue(T val)
     _count++;
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-inline T DoubleLinkedList<T>::Dequeue()
+inline T DoubleLinkedList<T, Allocator>::Dequeue()
 {
     return Pull();
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-void DoubleLinkedList<T>::Insert(T val, int index)
+void DoubleLinkedList<T, Allocator>::Insert(const T &val, int index)
 {
     if (index > _count)
         panic(fmt::format("Index {} is out of bounds: current count {}", index, _count));
@@ -196,7 +201,7 @@ void DoubleLinkedList<T>::Insert(T val, int index)
         Enqueue(val);
     else
     {
-        Node<T> *newNode = new Node<T>(val);
+        Node<T> *newNode = _allocator.Acquire(val);
         auto itr = (begin() + index);
         auto ptr = itr();
         Node<T> &prev = (itr--)();
@@ -206,23 +211,23 @@ void DoubleLinkedList<T>::Insert(T val, int index)
     }
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-void DoubleLinkedList<T>::Insert(T val, std::function<bool(const T &, const T &)> comparer)
+void DoubleLinkedList<T, Allocator>::Insert(const T &val, std::function<bool(const T &, const T &)> comparer)
 {
-    Node<T> *newNode = new Node<T>(val);
     auto itr = begin();
-    if (_begin == nullptr || comparer(*itr, newNode->Value()))
+    if (_begin == nullptr || comparer(itr.const_value(), val))
         Push(val);
     else
     {
-        while (itr != end() && !comparer(*itr, newNode->Value()))
+        while (itr != end() && !comparer(itr.const_value(), val))
             itr++;
 
-        if (itr == end() && !comparer(*itr, newNode->Value()))
+        if (itr == end() && !comparer(itr.const_value(), val))
             Enqueue(val);
         else
         {
+            Node<T> *newNode = _allocator.Acquire(val);
             Node<T> *prev = itr()->Previous();
             *prev >> *newNode;
             *itr() << *newNode;
@@ -231,9 +236,9 @@ void DoubleLinkedList<T>::Insert(T val, std::function<bool(const T &, const T &)
     }
 }
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
-inline void DoubleLinkedList<T>::Clear()
+inline void DoubleLinkedList<T, Allocator>::Clear()
 {
     if (_count == 0)
         return;
@@ -242,32 +247,27 @@ inline void DoubleLinkedList<T>::Clear()
     {
         Node<T> *prev = itr();
         itr++;
-        delete prev;
+        _allocator.Release(prev);
     }
-    delete _end;
+    _allocator.Release(_end);
     _begin = nullptr;
     _end = nullptr;
     _count = 0;
 }
 
-template <typename T>
-    requires Comparable<T>
-int DoubleLinkedList<T>::_refcount = 0;
-
-template <typename T>
+template <class T, class Allocator>
     requires Comparable<T>
-inline DoubleLinkedList<T>::~DoubleLinkedList()
+inline DoubleLinkedList<T, Allocator>::~DoubleLinkedList()
 {
-    _refcount--;
-    if (_refcount == 0)
+    if (_owners.use_count() == 1)
         Clear();
 }
 
-template <typename T>
+template <class T, class Allocator>
     requires Comparable<T>
-inline DoubleLinkedList<T> DoubleLinkedList<T>::Take(std::function<bool(const T &)> predicate)
+inline DoubleLinkedList<T, Allocator> DoubleLinkedList<T, Allocator>::Take(std::function<bool(const T &)> predicate)
 {
-    auto list = DoubleLinkedList{};
+    DoubleLinkedList list{_allocator};
     for (auto e : *this)
     {
         if (predicate(e))
@@ -278,7 +278,7 @@ inline DoubleLinkedList<T> DoubleLinkedList<T>::Take(std::function<bool(const T
     return list;
 }
 
-template <typename T> struct fmt::formatter<DoubleLinkedList<T>>
+template <typename T, typename Allocator> struct fmt::formatter<DoubleLinkedList<T, Allocator>>
 {
     FormatParser p{};
     constexpr auto parse(format_parse_context &ctx) -> format_parse_context::iterator
@@ -286,7 +286,7 @@ template <typename T> struct fmt::formatter<DoubleLinkedList<T>>
         return p.parse(ctx);
     }
 
-    auto format(const DoubleLinkedList<T> &list, format_context &ctx) const -> format_context::iterator
+    auto format(const DoubleLinkedList<T, Allocator> &list, format_context &ctx) const -> format_context::iterator
     {
         std::string result = "";
         if (list.Count() == 0)
@@ -1,3 +1,4 @@
+#pragma once
 
 #include <algorithm>
 #include <concepts>
@@ -10,13 +11,15 @@ concept Comparable = requires(T a) {
     };
 };
 
-template <class T>
+template <class T, class Allocator>
     requires Comparable<T>
 class DoubleLinkedList;
 
 template <typename T> class Node
 {
-    friend class DoubleLinkedList<T>;
+    template <class U, class Allocator>
+        requires Comparable<U>
+    friend class DoubleLinkedList;
 
   private:
     T _val;
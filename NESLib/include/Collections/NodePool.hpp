@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Collections/Node.hpp"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Free list of list nodes carved out of fixed size blocks.
+ * @note Released nodes are recycled by the next Acquire, memory is given back only when the pool is destroyed, so
+ * nodes still linked in a list at that point are dropped without running their destructor.
+ */
+template <typename T> class NodePool
+{
+    static_assert(std::is_trivially_destructible_v<T>, "pooled nodes are released in bulk without destructors");
+
+  private:
+    static constexpr size_t BLOCK_SIZE = 256;
+    union Slot {
+        Slot *next;
+        alignas(Node<T>) std::byte node[sizeof(Node<T>)];
+    };
+    std::vector<std::unique_ptr<Slot[]>> _blocks{};
+    Slot *_free = nullptr;
+    size_t _inUse = 0;
+
+    void Grow()
+    {
+        _blocks.emplace_back(new Slot[BLOCK_SIZE]);
+        Slot *block = _blocks.back().get();
+        for (size_t i = 0; i < BLOCK_SIZE; i++)
+        {
+            block[i].next = _free;
+            _free = &block[i];
+        }
+    }
+
+  public:
+    NodePool() = default;
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    Node<T> *Acquire(const T &value)
+    {
+        if (_free == nullptr)
+            Grow();
+        Slot *slot = _free;
+        _free = slot->next;
+        _inUse++;
+        return new (slot->node) Node<T>(value);
+    }
+
+    void Release(Node<T> *node)
+    {
+        node->~Node();
+        Slot *slot = reinterpret_cast<Slot *>(node);
+        slot->next = _free;
+        _free = slot;
+        _inUse--;
+    }
+
+    size_t Capacity() const
+    {
+        return _blocks.size() * BLOCK_SIZE;
+    }
+
+    size_t InUse() const
+    {
+        return _inUse;
+    }
+};
+
+template <typename T> struct HeapNodeAllocator
+{
+    Node<T> *Acquire(const T &value)
+    {
+        return new Node<T>(value);
+    }
+
+    void Release(Node<T> *node)
+    {
+        delete node;
+    }
+};
+
+// lists sharing the same pool recycle each other nodes, a default constructed allocator creates its own pool
+template <typename T> class PooledNodeAllocator
+{
+  private:
+    std::shared_ptr<NodePool<T>> _pool;
+
+  public:
+    PooledNodeAllocator() = default;
+    PooledNodeAllocator(std::shared_ptr<NodePool<T>> pool) : _pool(pool)
+    {
+    }
+
+    Node<T> *Acquire(const T &value)
+    {
+        if (_pool == nullptr)
+            _pool = std::make_shared<NodePool<T>>();
+        return _pool->Acquire(value);
+    }
+
+    void Release(Node<T> *node)
+    {
+        _pool->Release(node);
+    }
+
+    const std::shared_ptr<NodePool<T>> &Pool() const
+    {
+        return _pool;
+    }
+};
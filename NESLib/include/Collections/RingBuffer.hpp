@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Bounded multi producer single consumer queue.
+ * @note Every slot carries a sequence number telling whose turn it is: producers claim a position with a CAS on the
+ * enqueue counter, the consumer is the only one advancing the dequeue counter. Push and Pop never lock, a full buffer
+ * makes TryPush fail and the caller decides whether to drop or retry. The capacity is rounded up to a power of two.
+ */
+template <typename T> class RingBuffer
+{
+  private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _enqueuePos{0};
+    alignas(64) size_t _dequeuePos = 0;
+
+    static size_t RoundCapacity(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+  public:
+    RingBuffer(size_t capacity) : _mask{RoundCapacity(capacity) - 1}
+    {
+        _slots = std::make_unique<Slot[]>(_mask + 1);
+        for (size_t i = 0; i <= _mask; i++)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    // thread safe for any number of producers
+    bool TryPush(T &&value)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot &slot = _slots[pos & _mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+            if (diff == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // the consumer has not freed this slot yet
+            else
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // consumer thread only
+    bool TryPop(T &value)
+    {
+        Slot &slot = _slots[_dequeuePos & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) != _dequeuePos + 1)
+            return false;
+        value = std::move(slot.value);
+        slot.sequence.store(_dequeuePos + _mask + 1, std::memory_order_release);
+        _dequeuePos++;
+        return true;
+    }
+
+    // number of positions claimed by producers so far, pushes that failed are not counted
+    size_t Pushed() const
+    {
+        return _enqueuePos.load(std::memory_order_acquire);
+    }
+
+    // consumer thread only
+    size_t Popped() const
+    {
+        return _dequeuePos;
+    }
+
+    size_t Capacity() const
+    {
+        return _mask + 1;
+    }
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read only view of a sample file mapped in memory.
+ * @note The pages are loaded by the OS on access, nothing is copied. The view stays valid until it is destroyed even
+ * if the store keeps appending to the file, it just does not see the new samples.
+ */
+class MappedSamples
+{
+  private:
+    const double *_data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void *_file = nullptr;
+    void *_mapping = nullptr;
+#endif
+
+    void Release();
+
+  public:
+    MappedSamples() = default;
+    MappedSamples(const std::string &path);
+    MappedSamples(const MappedSamples &) = delete;
+    MappedSamples &operator=(const MappedSamples &) = delete;
+    MappedSamples(MappedSamples &&other) noexcept;
+    MappedSamples &operator=(MappedSamples &&other) noexcept;
+    ~MappedSamples();
+
+    // false if the file is missing or empty
+    bool IsValid() const
+    {
+        return _data != nullptr;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    const double *data() const
+    {
+        return _data;
+    }
+
+    double operator[](size_t i) const
+    {
+        return _data[i];
+    }
+
+    const double *begin() const
+    {
+        return _data;
+    }
+
+    const double *end() const
+    {
+        return _data + _size;
+    }
+
+    std::span<const double> Span() const
+    {
+        return {_data, _size};
+    }
+};
+
+/**
+ * @brief Append only store of samples holding at most one window in memory.
+ * @note When a path is given every full window is appended to that file as raw native endian doubles, with no
+ * header, so the file can be mapped as it is (MappedSamples here, numpy.memmap with dtype float64 in the scripts).
+ * Without a path the store keeps every sample in memory as BufferedMeasure always did. A window the file does not
+ * take entirely stays in memory and is written again once another window is pushed, a file that cannot be reopened
+ * on Clear leaves the store in memory.
+ */
+class SampleStore
+{
+  private:
+    std::vector<double> _window{};
+    size_t _windowSize;
+    std::string _path;
+    std::FILE *_file = nullptr;
+    size_t _spilled = 0;
+    size_t _spillAt;
+
+    void Spill();
+
+  public:
+    SampleStore(size_t windowSize = 4096, std::string path = "");
+    SampleStore(const SampleStore &) = delete;
+    SampleStore &operator=(const SampleStore &) = delete;
+    ~SampleStore();
+
+    void Push(double value)
+    {
+        _window.push_back(value);
+        if (_file != nullptr && _window.size() == _spillAt)
+            Spill();
+    }
+
+    // samples pushed since the last Clear, in memory or on disk
+    size_t Size() const
+    {
+        return _spilled + _window.size();
+    }
+
+    size_t Spilled() const
+    {
+        return _spilled;
+    }
+
+    // samples not yet written to the file
+    const std::vector<double> &Window() const
+    {
+        return _window;
+    }
+
+    const std::string &Path() const
+    {
+        return _path;
+    }
+
+    bool IsSpilling() const
+    {
+        return _file != nullptr;
+    }
+
+    // writes the samples still in memory, after this the file holds all of them
+    void Flush();
+    // drops every sample and truncates the file, release the mapped views before on Windows
+    void Clear();
+    // flushes and maps the file, a store without a file or that could not write every sample gives an invalid view
+    MappedSamples Map();
+};
@@ -1,9 +1,10 @@
+#pragma once
 #include "Event.hpp"
 #include "ISimulator.hpp"
 #include "Station.hpp"
 #include <functional>
 
-struct DelayStation : public Station
+struct DelayStation final : public Station
 {
   protected:
     IScheduler *_scheduler;
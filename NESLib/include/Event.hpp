@@ -1,9 +1,13 @@
 #pragma once
 #include "FormatParser.hpp"
 #include <cstddef>
+#include <cstdint>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 enum EventType : char
 {
@@ -16,56 +20,81 @@ enum EventType : char
     RESET= 'R'
 };
 
+/**
+ * @brief Side table for the names of the events.
+ * @note Customers are identified only by their numeric id, named events (END, SYNC, ...) get an id with the NAMED bit
+ * set, so a name never travels with the event.
+ */
+struct EventNames
+{
+    static constexpr uint64_t NAMED = 1ull << 63;
+    static uint64_t Intern(std::string_view name);
+    static std::string Lookup(uint64_t id);
+    static bool IsNamed(uint64_t id)
+    {
+        return (id & NAMED) != 0;
+    }
+};
+
+// a name interned once, keep it in a static so building the event does not go through the side table
+struct EventName
+{
+    uint64_t Id;
+    explicit EventName(std::string_view name) : Id(EventNames::Intern(name))
+    {
+    }
+};
+
 struct Event
 {
-    int Station = 0;
-    int *copyCounter = nullptr;
-    static int GeneratedNodes;
-    static int DeletedNodes;
+    uint64_t Id = 0;
     double CreateTime = 0.0;
     double OccurTime = 0.0;
     double ServiceTime = 0.0;
     double ArrivalTime = 0.0;
-    std::string Name{};
+    // when the customer entered the station it is visiting, the stations stamp it on arrival
+    double StationArrival = 0.0;
+    int Station = 0;
     char Type = EventType::NO_EVENT;
     char SubType = EventType::NO_EVENT;
-    Event()
+
+    Event() = default;
+
+    Event(uint64_t id, char type, double createTime, double occurTime, double serviceTime, double arrivalTime,
+          int stationTarget = 0)
+        : Id{id}, CreateTime{createTime}, OccurTime{occurTime}, ServiceTime{serviceTime}, ArrivalTime{arrivalTime},
+          Station(stationTarget), Type{type}
     {
-        copyCounter = new int();
     }
-    Event(std::string name, char type, double createTime, double occurTime, double serviceTime, double arrivalTime,
+
+    Event(EventName name, char type, double createTime, double occurTime, double serviceTime, double arrivalTime,
           int stationTarget = 0)
-        : Name{name}, Type{type}, CreateTime{createTime}, OccurTime{occurTime}, ServiceTime{serviceTime},
-          ArrivalTime{arrivalTime}, Station(stationTarget)
+        : Event(name.Id, type, createTime, occurTime, serviceTime, arrivalTime, stationTarget)
     {
-        Event::GeneratedNodes++;
-        copyCounter = new int();
     }
-    ~Event()
+
+    // interns the name under the lock of the side table, for the cold paths only
+    Event(std::string_view name, char type, double createTime, double occurTime, double serviceTime,
+          double arrivalTime, int stationTarget = 0)
+        : Event(EventName{name}, type, createTime, occurTime, serviceTime, arrivalTime, stationTarget)
     {
-        if (*copyCounter > 0)
-            (*copyCounter)--;
-        else
-            DeletedNodes++;
-        Name.clear();
     }
 
-    Event(const Event &evt)
-        : Name(evt.Name), Type(evt.Type), CreateTime(evt.CreateTime), OccurTime(evt.OccurTime),
-          ServiceTime(evt.ServiceTime), ArrivalTime(evt.ArrivalTime), Station(evt.Station), SubType(evt.SubType),
-          copyCounter(evt.copyCounter)
+    std::string Name() const
     {
-        (*copyCounter)++;
+        return EventNames::Lookup(Id);
     }
 
-    bool operator==(Event &oth);
+    bool operator==(const Event &oth) const;
 };
 
+static_assert(std::is_trivially_copyable_v<Event>, "Event must stay a plain record");
+
 template <> struct fmt::formatter<Event> : formatter<string_view>
 {
     auto format(const Event& evt, format_context& ctx) const -> format_context::iterator
     {
-        return fmt::format_to(ctx.out(), "J:{},OC:{:2f},Tp:{},Station:{}", evt.Name, evt.OccurTime, evt.Type,
+        return fmt::format_to(ctx.out(), "J:{},OC:{:2f},Tp:{},Station:{}", evt.Name(), evt.OccurTime, evt.Type,
                               evt.Station);
     }
 };
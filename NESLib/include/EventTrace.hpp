@@ -0,0 +1,151 @@
+#pragma once
+#include "Event.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One dequeued event in a binary trace.
+ * @note The file starts with a TraceHeader, then the station table (index, name length, name) and then the records,
+ * all in the native byte order of the machine that wrote them.
+ */
+struct TraceRecord
+{
+    double Clock;
+    uint64_t Id;
+    int32_t Station;
+    char Type;
+    char SubType;
+};
+
+static_assert(std::is_trivially_copyable_v<TraceRecord> && sizeof(TraceRecord) == 24, "records are written raw");
+
+struct TraceHeader
+{
+    static constexpr char MAGIC[8] = {'N', 'E', 'S', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t VERSION = 1;
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t stations;
+    uint32_t reserved;
+};
+
+using TraceStations = std::vector<std::pair<int, std::string>>;
+
+// appends records to a buffer that goes to disk when full, on Flush and on destruction
+class TraceWriter
+{
+  private:
+    static constexpr size_t BUFFER_SIZE = 4096;
+    std::FILE *_file = nullptr;
+    std::unique_ptr<TraceRecord[]> _buffer;
+    size_t _count = 0;
+    size_t _written = 0;
+
+  public:
+    TraceWriter(const std::string &path, const TraceStations &stations);
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+    ~TraceWriter();
+
+    bool IsOpen() const
+    {
+        return _file != nullptr;
+    }
+
+    void Write(const Event &evt)
+    {
+        if (_count == BUFFER_SIZE)
+            Flush();
+        _buffer[_count++] = TraceRecord{evt.OccurTime, evt.Id, evt.Station, evt.Type, evt.SubType};
+    }
+
+    size_t Records() const
+    {
+        return _written + _count;
+    }
+
+    void Flush();
+};
+
+class TraceReader
+{
+  private:
+    std::FILE *_file = nullptr;
+    TraceStations _stations{};
+    long _firstRecord = 0;
+    size_t _count = 0;
+
+  public:
+    TraceReader(const std::string &path);
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+    ~TraceReader();
+
+    // false if the file is missing or is not a trace of this version
+    bool IsValid() const
+    {
+        return _file != nullptr;
+    }
+
+    const TraceStations &Stations() const
+    {
+        return _stations;
+    }
+
+    size_t Count() const
+    {
+        return _count;
+    }
+
+    // reads up to count records starting from the record first, returns how many were read
+    size_t Read(size_t first, TraceRecord *out, size_t count);
+};
+
+// per station statistics recomputed from a trace, with the same definitions used by BaseStation
+struct TraceStationStats
+{
+    std::string name;
+    int arrivals = 0;
+    int completions = 0;
+    int sysClients = 0;
+    int maxClients = 0;
+    double busyTime = 0.0;
+    double areaN = 0.0;
+    double observation = 0.0;
+
+    double utilization() const
+    {
+        return busyTime / observation;
+    }
+
+    double throughput() const
+    {
+        return completions / observation;
+    }
+
+    double mean_customer_system() const
+    {
+        return areaN / observation;
+    }
+
+    double avg_response() const
+    {
+        return areaN / completions;
+    }
+};
+
+/**
+ * @brief Replays a trace and recomputes the statistics of every station.
+ * @note A departure is a completion unless the next record of the same customer is another departure from the same
+ * station, which is how a preempted customer (end of a cpu quantum) shows in the trace. Statistics cover the whole
+ * trace, resets done by the simulation are not recorded.
+ */
+std::map<int, TraceStationStats> ReplayTrace(TraceReader &reader);
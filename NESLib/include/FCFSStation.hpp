@@ -19,6 +19,6 @@ class FCFSStation : public Station, public IQueueHolder
     void ProcessDeparture(Event &evt) override;
     void ProcessEnd(Event &evt) override;
     void ProcessProbe(Event &evt) override;
-    void Reset() override;
+    void ResetState() override;
     FCFSStation(IScheduler *scheduler, std::string name, int stationIndex);
 };
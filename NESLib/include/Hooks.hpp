@@ -0,0 +1,285 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename Signature, size_t Size = 32> class InlineFunction;
+
+/**
+ * @brief Move only callable stored in place.
+ * @note Callables up to Size bytes (every lambda capturing a few references or a string) live in the object itself,
+ * calling one is an indirect call through a function pointer with no allocation and no virtual dispatch. Larger ones
+ * are moved to the heap, as std::function would do.
+ */
+template <typename R, typename... Args, size_t Size> class InlineFunction<R(Args...), Size>
+{
+  private:
+    enum class Operation
+    {
+        MOVE,
+        DESTROY
+    };
+
+    R (*_invoke)(void *, Args...) = nullptr;
+    void (*_manage)(Operation, void *, void *) = nullptr;
+    alignas(void *) unsigned char _storage[Size];
+
+    static R Nothing(void *, Args...)
+    {
+        if constexpr (!std::is_void_v<R>)
+            return R{};
+    }
+
+    template <typename F> static constexpr bool Inline = sizeof(F) <= Size &&
+                                                         alignof(F) <= alignof(void *) &&
+                                                         std::is_nothrow_move_constructible_v<F>;
+
+    template <typename F> static F *Target(void *storage)
+    {
+        if constexpr (Inline<F>)
+            return std::launder(reinterpret_cast<F *>(storage));
+        else
+            return *reinterpret_cast<F **>(storage);
+    }
+
+    template <typename F> static void Manage(Operation operation, void *storage, void *other)
+    {
+        if constexpr (Inline<F>)
+        {
+            if (operation == Operation::MOVE)
+                ::new (storage) F(std::move(*Target<F>(other)));
+            Target<F>(operation == Operation::MOVE ? other : storage)->~F();
+        }
+        else if (operation == Operation::MOVE)
+            *reinterpret_cast<F **>(storage) = Target<F>(other);
+        else
+            delete Target<F>(storage);
+    }
+
+    void Release()
+    {
+        if (_manage != nullptr)
+            _manage(Operation::DESTROY, _storage, nullptr);
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+  public:
+    InlineFunction() = default;
+
+    template <typename F, typename D = std::decay_t<F>>
+        requires(!std::is_same_v<D, InlineFunction> && std::is_invocable_v<D &, Args...>)
+    InlineFunction(F &&fnc)
+    {
+        if constexpr (Inline<D>)
+            ::new (_storage) D(std::forward<F>(fnc));
+        else
+            *reinterpret_cast<D **>(_storage) = new D(std::forward<F>(fnc));
+        _invoke = [](void *storage, Args... args) -> R { return (*Target<D>(storage))(std::forward<Args>(args)...); };
+        _manage = &Manage<D>;
+    }
+
+    InlineFunction(InlineFunction &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    InlineFunction &operator=(InlineFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            if (other._manage != nullptr)
+                other._manage(Operation::MOVE, _storage, other._storage);
+            _invoke = other._invoke;
+            _manage = other._manage;
+            other._invoke = nullptr;
+            other._manage = nullptr;
+        }
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction &) = delete;
+    InlineFunction &operator=(const InlineFunction &) = delete;
+
+    ~InlineFunction()
+    {
+        Release();
+    }
+
+    explicit operator bool() const
+    {
+        return _invoke != nullptr;
+    }
+
+    R operator()(Args... args)
+    {
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+    // later calls do nothing, the callable is kept alive until destroyed since it may be the one running
+    void Disable()
+    {
+        if (_invoke != nullptr)
+            _invoke = &Nothing;
+    }
+
+    // calls the target and disables it before it runs, so a nested call does not run it twice
+    R CallOnce(Args... args)
+    {
+        auto invoke = _invoke;
+        Disable();
+        return invoke(_storage, std::forward<Args>(args)...);
+    }
+};
+
+// ids start from 1, 0 marks a removed hook
+using HookId = uint32_t;
+
+/**
+ * @brief Callbacks with stable ids that can be removed at any time, even from inside a callback.
+ * @note A removed hook is disabled in place and the list is compacted by the next dispatch that is not nested in
+ * another one, so the callback running when a removal happens is never destroyed under its feet and the loop needs no
+ * check per hook. Hooks added during a dispatch are parked aside and join the list at the next one. Dispatches may be
+ * nested. DispatchOnce retires every hook right before running it, for hooks that fire a single time.
+ */
+template <typename... Args> class HookList
+{
+  private:
+    struct Hook
+    {
+        HookId id;
+        InlineFunction<void(Args...)> fnc;
+    };
+    std::vector<Hook> _hooks{};
+    // hooks added while dispatching, a push_back on _hooks would move the running callable
+    std::vector<Hook> _added{};
+    // hooks not removed yet, parked ones included
+    uint32_t _live = 0;
+    // dispatches running, nested ones included
+    int _depth = 0;
+    // hooks were removed or parked since the last compaction
+    bool _changed = false;
+    static constexpr HookId REMOVED = 0;
+
+    void Retire(Hook &hook)
+    {
+        if (hook.id == REMOVED)
+            return;
+        hook.id = REMOVED;
+        hook.fnc.Disable();
+        _live--;
+    }
+
+    // kept out of line, the dispatch loops stay small where they are inlined
+    [[gnu::noinline]] void ApplyChanges()
+    {
+        std::erase_if(_hooks, [](Hook &hook) { return hook.id == REMOVED; });
+        for (auto &hook : _added)
+        {
+            if (hook.id != REMOVED)
+                _hooks.push_back(std::move(hook));
+        }
+        _added.clear();
+        _changed = false;
+    }
+
+  public:
+    void Add(HookId id, InlineFunction<void(Args...)> &&fnc)
+    {
+        _live++;
+        if (_depth > 0)
+        {
+            _added.push_back(Hook{id, std::move(fnc)});
+            _changed = true;
+        }
+        else
+            _hooks.push_back(Hook{id, std::move(fnc)});
+    }
+
+    bool Remove(HookId id)
+    {
+        if (id == REMOVED)
+            return false;
+        for (auto *hooks : {&_hooks, &_added})
+        {
+            for (auto &hook : *hooks)
+            {
+                if (hook.id == id)
+                {
+                    // the callable may be the one running, it is destroyed by the next compaction
+                    Retire(hook);
+                    _changed = true;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool Empty() const
+    {
+        return _live == 0;
+    }
+
+    size_t Size() const
+    {
+        return _live;
+    }
+
+    void Dispatch(Args... args)
+    {
+        if (_changed && _depth == 0)
+            ApplyChanges();
+        _depth++;
+        // removed hooks are disabled, _hooks does not move while any dispatch runs
+        for (auto &hook : _hooks)
+            hook.fnc(args...);
+        _depth--;
+    }
+
+    // runs every hook once and drops them, hooks added meanwhile wait for the next call; out of line, Process skips
+    // it on the events where Empty holds
+    [[gnu::noinline]] void DispatchOnce(Args... args)
+    {
+        if (_changed && _depth == 0)
+            ApplyChanges();
+        _depth++;
+        for (auto &hook : _hooks)
+        {
+            // retired before running, a nested dispatch or a Remove of its id no longer sees it
+            if (hook.id != REMOVED)
+            {
+                hook.id = REMOVED;
+                _live--;
+                hook.fnc.CallOnce(args...);
+            }
+        }
+        _changed = true;
+        if (--_depth == 0)
+            ApplyChanges();
+    }
+
+    void Clear()
+    {
+        if (_depth > 0)
+        {
+            // a callable of the list may be running, they are destroyed by the next compaction
+            for (auto *hooks : {&_hooks, &_added})
+            {
+                for (auto &hook : *hooks)
+                    Retire(hook);
+            }
+            _changed = true;
+            return;
+        }
+        _hooks.clear();
+        _added.clear();
+        _live = 0;
+        _changed = false;
+    }
+};
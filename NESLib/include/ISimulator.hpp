@@ -3,6 +3,8 @@
 #include "Event.hpp"
 #include "Station.hpp"
 #include "Usings.hpp"
+#include "rngs.hpp"
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -16,13 +18,17 @@ class ISimulator
 class IScheduler
 {
   public:
-    virtual void Schedule(Event event) = 0;
+    virtual void Schedule(const Event &event) = 0;
     virtual void Reset() = 0;
     virtual void Sync() = 0;
     virtual std::optional<sptr<Station>> GetStation(int index) = 0;
     virtual std::optional<sptr<Station>> GetStation(std::string name) = 0;
     virtual const std::vector<sptr<Station>> GetStations() const = 0;
     virtual double GetClock() = 0;
+    virtual uint64_t NewCustomerId() = 0;
+    virtual std::shared_ptr<NodePool<Event>> EventNodes() = 0;
+    // generator shared by the random streams of the stations of this simulation
+    virtual RandomStream &Generator() = 0;
 };
 
 class IQueueHolder
@@ -30,5 +36,11 @@ class IQueueHolder
   protected:
   EventList _eventList;
   public:
+  IQueueHolder() = default;
+  // queue nodes come from the scheduler pool, so they are recycled across all the stations of a simulation
+  IQueueHolder(IScheduler *scheduler)
+      : _eventList(PooledNodeAllocator<Event>{scheduler != nullptr ? scheduler->EventNodes() : nullptr})
+  {
+  }
   EventList& GetEventList(){return _eventList;}
 };
\ No newline at end of file
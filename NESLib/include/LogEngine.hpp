@@ -1,11 +1,14 @@
 #pragma once
 
+#include "Collections/RingBuffer.hpp"
 #include "FormatParser.hpp"
 #include <fmt/core.h>
+#include <atomic>
 #include <fmt/format.h>
 #include <iostream>
-#include <sstream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -18,6 +21,11 @@ enum class LogType : int
     TRANSFER
 };
 
+// most verbose LogType compiled in, calls above it are removed along with the formatting of their arguments
+#ifndef NES_MIN_LOG_LEVEL
+#define NES_MIN_LOG_LEVEL 4
+#endif
+
 template <> struct fmt::formatter<enum LogType> : formatter<string_view>
 {
     auto format(const LogType &type, format_context &ctx) const -> format_context::iterator
@@ -40,7 +48,7 @@ template <> struct fmt::formatter<enum LogType> : formatter<string_view>
 };
 
 // use for dynamic format, else use fmt::format
-template <typename... Args> std::string makeformat(const char *format, Args... args)
+template <typename... Args> std::string makeformat(const char *format, const Args &...args)
 {
     return std::move(std::string(fmt::vformat(std::string(format), fmt::make_format_args(args...))));
 }
@@ -48,23 +56,55 @@ template <typename... Args> std::string makeformat(const char *format, Args... a
 struct TraceSource;
 
 struct LogLocker;
+// what Trace does when the writer thread is behind and the record buffer is full
+enum class LogOverflow : int
+{
+    DROP, // the record is discarded and counted, exceptions and results are never dropped
+    BLOCK // the caller waits for the writer to free a slot
+};
+
+/**
+ * @brief Process wide log sink.
+ * @note Trace only formats the record and pushes it in a bounded ring buffer, a dedicated writer thread prints it on
+ * stdout and appends it to the log file, which stays open for the engine lifetime. Flush waits until every record
+ * traced before the call is on disk. Whether a record goes to stdout is decided when it is traced. The engine is
+ * destroyed at exit, or when CreateInstance replaces it, after the writer saved every record; neither may happen while
+ * other threads are tracing.
+ */
 class LogEngine
 {
     friend struct TraceSource;
     friend struct LogLocker;
 
   private:
-    bool _printStdout = true;
-    bool _pauseStdout = false;
-    std::stringstream _buffer;
+    struct Record
+    {
+        LogType type;
+        std::string message;
+        bool print;
+    };
+
+    std::atomic<bool> _printStdout = true;
+    std::atomic<bool> _pauseStdout = false;
     std::string _logFile;
     static LogEngine *_instance;
     std::vector<TraceSource *> _sources;
-    LogEngine()
-    {
-    }
-    LogEngine(std::string logFile) : _logFile{logFile}
-    {
+    // simulations running on different threads share the engine, the mutex guards only the sources
+    std::mutex _mutex;
+    LogOverflow _overflow;
+    RingBuffer<Record> _records;
+    std::atomic<size_t> _dropped = 0;
+    // bumped on every push, the writer sleeps on it when the buffer is empty
+    std::atomic<size_t> _published = 0;
+    // records consumed and written, Flush sleeps on it
+    std::atomic<size_t> _written = 0;
+    std::atomic<bool> _running = true;
+    std::thread _writer;
+    void WriterLoop();
+    LogEngine(std::string logFile, LogOverflow overflow, size_t capacity)
+        : _logFile{logFile}, _overflow{overflow}, _records{capacity}
+    {
+        _writer = std::thread([this] { WriterLoop(); });
     }
 
   public:
@@ -72,20 +112,23 @@ class LogEngine
     virtual void Trace(LogType type, std::string message);
     void AddSource(TraceSource *source)
     {
+        std::lock_guard<std::mutex> lock{_mutex};
         _sources.push_back(source);
     }
-    static void CreateInstance(std::string logFile)
-    {
-        _instance = new LogEngine(logFile);
-    }
+    static void CreateInstance(std::string logFile, LogOverflow overflow = LogOverflow::DROP,
+                               size_t capacity = 1 << 14);
+    // writes the pending records, stops the writer and closes the log file
+    static void DestroyInstance();
 
-    const std::vector<TraceSource *> GetSources() const
+    const std::vector<TraceSource *> GetSources()
     {
+        std::lock_guard<std::mutex> lock{_mutex};
         return _sources;
     }
 
     void RemoveSource(TraceSource *src)
     {
+        std::lock_guard<std::mutex> lock{_mutex};
         for (int i = 0; i < _sources.size(); i++)
         {
             if (_sources[i] == src)
@@ -101,6 +144,13 @@ class LogEngine
     {
         _printStdout = value;
     }
+
+    size_t Dropped() const
+    {
+        return _dropped.load();
+    }
+
+    virtual ~LogEngine();
 };
 
 struct LogLocker
@@ -109,9 +159,11 @@ struct LogLocker
     LogEngine *_instance;
 
   public:
+    // the records traced before are printed first, the ones traced while locked go only to the log file
     LogLocker()
     {
         _instance = LogEngine::Instance();
+        _instance->Flush();
         _instance->_pauseStdout = true;
     }
 
@@ -142,43 +194,59 @@ struct TraceSource
             engine = nullptr;
         }
     }
-    void Trace(LogType type, std::string message)
+    bool Enabled(LogType type)
     {
         if (engine == nullptr || LogEngine::_instance != engine)
             Init();
-        if (verbosity >= (int)type && engine != nullptr)
+        return verbosity >= (int)type && engine != nullptr;
+    }
+
+    void Trace(LogType type, std::string message)
+    {
+        if (Enabled(type))
         {
             engine->Trace(type, fmt::format("({}){}", sourceName, message));
         }
     }
 
-    template <typename... Args> void Exception(const char *format, Args... args)
+    // the message is formatted only when the source would trace it
+    template <LogType type, typename... Args> void Log(const char *format, const Args &...args)
+    {
+        if constexpr ((int)type <= NES_MIN_LOG_LEVEL)
+        {
+            if (Enabled(type))
+                engine->Trace(type, fmt::format("({}){}", sourceName, makeformat(format, args...)));
+        }
+    }
+
+    template <typename... Args> void Exception(const char *format, const Args &...args)
     {
-        Trace(LogType::EXCEPTION, makeformat(format, args...));
+        Log<LogType::EXCEPTION>(format, args...);
     }
 
-    template <typename... Args> void Information(const char *format, Args... args)
+    template <typename... Args> void Information(const char *format, const Args &...args)
     {
-        Trace(LogType::INFORMATION, makeformat(format, args...));
+        Log<LogType::INFORMATION>(format, args...);
     }
 
-    template <typename... Args> void Transfer(const char *format, Args... args)
+    template <typename... Args> void Transfer(const char *format, const Args &...args)
     {
-        Trace(LogType::TRANSFER, makeformat(format, args...));
+        Log<LogType::TRANSFER>(format, args...);
     }
 
-    template <typename... Args> void Result(const char *format, Args... args)
+    template <typename... Args> void Result(const char *format, const Args &...args)
     {
-        Trace(LogType::RESULT, makeformat(format, args...));
+        Log<LogType::RESULT>(format, args...);
     }
 
-    template <typename... Args> void Debug(const char *format, Args... args)
+    template <typename... Args> void Debug(const char *format, const Args &...args)
     {
-        Trace(LogType::DEBUG, makeformat(format, args...));
+        Log<LogType::DEBUG>(format, args...);
     }
     ~TraceSource()
     {
-        if (engine != nullptr)
+        // an engine that was replaced or destroyed is gone along with its sources
+        if (engine != nullptr && engine == LogEngine::_instance)
             engine->RemoveSource(this);
     }
 };
\ No newline at end of file
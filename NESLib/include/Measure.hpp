@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "Collections/SampleStore.hpp"
 #include "Core.hpp"
 #include "LogEngine.hpp"
 #include "Measure.hpp"
@@ -11,14 +12,18 @@
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <valarray>
 #include <vector>
@@ -156,25 +161,98 @@ template <typename T> class Measure : public BaseMeasure
     }
 };
 
+namespace helper
+{
+// compact state of the measures in native byte order, so results of other workers merge without their samples
+template <typename T> void write_state(std::string &out, const T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> bool read_state(std::string_view &in, T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (in.size() < sizeof(T))
+        return false;
+    memcpy(&value, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+constexpr double ipow(double base, int exponent)
+{
+    double result = 1.0;
+    for (int i = 0; i < exponent; i++)
+        result *= base;
+    return result;
+}
+
+constexpr double binomial(int n, int k)
+{
+    double result = 1.0;
+    for (int i = 1; i <= k; i++)
+        result = result * (n - k + i) / i;
+    return result;
+}
+} // namespace helper
+
+/**
+ * @brief Streaming mean and central moments of a sample.
+ * @note Keeps the mean and the sums of the powers of the deviations from it, updated with the pairwise formulas of
+ * Pebay (a single value is a partition of one sample), so there is no cancellation between large raw sums and two
+ * accumulators filled on different threads can be merged. The moments are expanded at compile time.
+ */
 template <int Moments = 2> class Accumulator : public Measure<double>
 {
+    static_assert(Moments >= 1, "at least the mean must be stored");
 
   private:
     double _confidence = 0.95;
     double _precision = 0.05;
-    double _sum[Moments]{};
+    double _mean = 0.0;
+    // _central[p] is the sum of (x - mean)^p, the first two are unused
+    double _central[Moments + 1]{};
 
-    double get(int moment) const
+    // updates the central sum of order P with a partition of countB samples, mean at distance delta and sums central
+    template <int P> void CombineMoment(double countA, double countB, double delta, const double *central)
     {
-        if (moment >= Moments)
-            panic("moment selected is over Moments stored");
-        return _sum[moment];
+        double count = countA + countB;
+        double result = _central[P] + central[P];
+        for (int k = 1; k <= P - 2; k++)
+            result += helper::binomial(P, k) * helper::ipow(delta, k) *
+                      (helper::ipow(-countB / count, k) * _central[P - k] +
+                       helper::ipow(countA / count, k) * central[P - k]);
+        result += helper::ipow(countA * countB * delta / count, P) *
+                  (1.0 / helper::ipow(countB, P - 1) - helper::ipow(-1.0 / countA, P - 1));
+        _central[P] = result;
     }
 
-    void constexpr ForMoment(std::function<void(double &, int)> &&operation)
+    // higher orders first, each one reads the lower orders before they are updated
+    template <int... P>
+    void CombineMoments(std::integer_sequence<int, P...>, double countA, double countB, double delta,
+                        const double *central)
     {
-        for (int i = 0; i < Moments; i++)
-            operation(_sum[i], i + 1);
+        (CombineMoment<Moments - P>(countA, countB, delta, central), ...);
+    }
+
+    void Combine(size_t countB, double meanB, const double *central)
+    {
+        if (countB == 0)
+            return;
+        double countA = _count;
+        if (_count > 0)
+        {
+            double delta = meanB - _mean;
+            CombineMoments(std::make_integer_sequence<int, Moments - 1>{}, countA, countB, delta, central);
+            _mean += delta * countB / (countA + countB);
+        }
+        else
+        {
+            _mean = meanB;
+            for (int p = 2; p <= Moments; p++)
+                _central[p] = central[p];
+        }
     }
 
   public:
@@ -200,11 +278,34 @@ template <int Moments = 2> class Accumulator : public Measure<double>
 
     void Accumulate(double value) override
     {
+        static constexpr double single[Moments + 1]{};
+        Combine(1, value, single);
         Measure<double>::Accumulate(value);
-        ForMoment([value](double &val, int moment) {
-            val += pow(value, moment);
-            core_assert(val != NAN, "Value {} is drifting in moment {}", val, moment);
-        });
+        core_assert(!std::isnan(_mean), "Value {} is drifting", _mean);
+    }
+
+    // adds the samples of another accumulator, as if they were accumulated here
+    void Merge(const Accumulator<Moments> &other)
+    {
+        Combine(other._count, other._mean, other._central);
+        _count += other._count;
+    }
+
+    void Serialize(std::string &out) const
+    {
+        helper::write_state(out, _count);
+        helper::write_state(out, _mean);
+        for (int p = 2; p <= Moments; p++)
+            helper::write_state(out, _central[p]);
+    }
+
+    // replaces the state with one written by Serialize, consuming it from in
+    bool Deserialize(std::string_view &in)
+    {
+        bool valid = helper::read_state(in, _count) && helper::read_state(in, _mean);
+        for (int p = 2; valid && p <= Moments; p++)
+            valid = helper::read_state(in, _central[p]);
+        return valid;
     }
 
     std::string Heading() override
@@ -239,22 +340,37 @@ template <int Moments = 2> class Accumulator : public Measure<double>
     virtual void Reset() override
     {
         Measure<double>::Reset();
-        ForMoment([](double &val, int moment) { val = 0; });
+        _mean = 0.0;
+        for (int p = 0; p <= Moments; p++)
+            _central[p] = 0.0;
     }
 
+    // raw moment of order moment + 1, the mean for 0
     inline double mean(int moment = 0) const
     {
-        return get(moment) / Count();
+        if (moment >= Moments)
+            panic("moment selected is over Moments stored");
+        if (moment == 0)
+            return _mean;
+        int order = moment + 1;
+        double result = 0.0;
+        for (int k = 0; k <= order; k++)
+        {
+            double central = k == 0 ? 1.0 : (k == 1 ? 0.0 : _central[k] / Count());
+            result += helper::binomial(order, k) * helper::ipow(_mean, order - k) * central;
+        }
+        return result;
     }
 
     inline double variance() const
     {
-        return mean(1) - pow(mean(0), 2); // this can lead to catastrophic cancellation
+        static_assert(Moments >= 2, "the variance needs the second moment");
+        return _central[2] / Count();
     }
 
     inline double sum() const
     {
-        return _sum[0];
+        return _mean * Count();
     }
 
     Interval confidence()
@@ -311,31 +427,40 @@ template <> struct fmt::formatter<Accumulator<>>
     }
 };
 
+// keeps every sample, at most one window of them in memory when a spill file is given
 template <int Moments = 2> struct BufferedMeasure : public Accumulator<Moments>
 {
   private:
-    std::vector<double> data{};
+    SampleStore data;
 
   public:
     virtual void Accumulate(double value) override
     {
         Accumulator<Moments>::Accumulate(value);
-        data.push_back(value);
+        data.Push(value);
     }
 
-    BufferedMeasure(std::string name, std::string unit) : Accumulator<Moments>(name, unit)
+    BufferedMeasure(std::string name, std::string unit, size_t window = 4096, std::string spillPath = "")
+        : Accumulator<Moments>(name, unit), data(window, spillPath)
     {
     }
 
     virtual void Reset() override
     {
-        Accumulator<>::Reset();
-        data.clear();
+        Accumulator<Moments>::Reset();
+        data.Clear();
     }
-    const std::vector<double> &Data()
+
+    const SampleStore &Data() const
     {
         return data;
     }
+
+    // every sample since the last reset, mapped from the spill file
+    MappedSamples Map()
+    {
+        return data.Map();
+    }
 };
 
 template <> struct fmt::formatter<BufferedMeasure<>> : fmt::formatter<string_view>
@@ -346,7 +471,7 @@ template <> struct fmt::formatter<BufferedMeasure<>> : fmt::formatter<string_vie
             ctx.out(),
             "Measure: {}, Mean: {}, Variance:{}, Precision:{}, Samples:{}, LB:{}, LH:{},LastValue:{},BufferSize:{}",
             m.Name(), m.mean(), m.variance(), m.confidence().precision(), m.Count(), m.confidence().lower(),
-            m.confidence().higher(), m.Current(), m.Data().size());
+            m.confidence().higher(), m.Current(), m.Data().Size());
     }
 };
 
@@ -405,6 +530,29 @@ template <int Esembles = 2> struct EsembledMeasure : public Measure<double>
         return accs[esemble];
     }
 
+    // merges every ensemble with the same ensemble of other
+    void Merge(const EsembledMeasure<Esembles> &other)
+    {
+        _count += other._count;
+        for (int i = 0; i < Esembles; i++)
+            accs[i].Merge(other.accs[i]);
+    }
+
+    void Serialize(std::string &out) const
+    {
+        helper::write_state(out, _count);
+        for (int i = 0; i < Esembles; i++)
+            accs[i].Serialize(out);
+    }
+
+    bool Deserialize(std::string_view &in)
+    {
+        bool valid = helper::read_state(in, _count);
+        for (int i = 0; valid && i < Esembles; i++)
+            valid = accs[i].Deserialize(in);
+        return valid;
+    }
+
     Interval confidence()
     {
         return accs[Esembles - 1].confidence();
@@ -429,6 +577,163 @@ template <int Esemble> struct fmt::formatter<EsembledMeasure<Esemble>>
     }
 };
 
+/**
+ * @brief Quantiles of a non negative sample in fixed memory.
+ * @note Logarithmic buckets as in DDSketch: every value is counted in the bucket ceil(log_gamma(value)) with
+ * gamma = (1 + accuracy) / (1 - accuracy), so a quantile is returned within the relative accuracy of the true one.
+ * When the samples span more than maxBins buckets the lowest ones are folded together, only low quantiles lose
+ * accuracy. Two sketches with the same accuracy merge by adding their buckets.
+ */
+class QuantileMeasure : public Measure<double>
+{
+  private:
+    static constexpr double MIN_VALUE = 1e-12; // smaller values are counted as zeros
+    double _accuracy;
+    double _logGamma;
+    size_t _maxBins;
+    int _offset = 0; // key of _bins[0]
+    std::vector<uint64_t> _bins{};
+    uint64_t _zeros = 0;
+    double _min = std::numeric_limits<double>::infinity();
+    double _max = -std::numeric_limits<double>::infinity();
+
+    int Key(double value) const
+    {
+        return (int)std::ceil(std::log(value) / _logGamma);
+    }
+
+    // index of the bucket of key, widening the buckets and folding the lowest ones if needed
+    size_t Index(int key);
+
+  public:
+    QuantileMeasure(std::string name, std::string unit, double accuracy = 0.01, size_t maxBins = 2048);
+
+    QuantileMeasure() : QuantileMeasure("", "")
+    {
+    }
+
+    void Accumulate(double value) override;
+    // value below which the fraction q of the samples falls, q in [0,1]
+    double Quantile(double q) const;
+    void Merge(const QuantileMeasure &other);
+    void Serialize(std::string &out) const;
+    bool Deserialize(std::string_view &in);
+
+    double Accuracy() const
+    {
+        return _accuracy;
+    }
+
+    std::string Heading() override;
+    std::string Csv() override;
+    std::string Json() override;
+    void Reset() override;
+};
+
+template <> struct fmt::formatter<QuantileMeasure> : formatter<string_view>
+{
+    auto format(const QuantileMeasure &m, format_context &ctx) const -> format_context::iterator
+    {
+        return fmt::format_to(ctx.out(), "Measure: {}, P50:{}, P95:{}, P99:{}, Samples:{}", m.Name(), m.Quantile(0.5),
+                              m.Quantile(0.95), m.Quantile(0.99), m.Count());
+    }
+};
+
+/**
+ * @brief Batch means estimator of the mean of a correlated, stationary sequence.
+ * @note Samples are averaged in batches that are kept in a fixed number of slots: when the slots are full adjacent
+ * batches are averaged in pairs and the batch size doubles, so memory stays constant on any run length. The batch size
+ * used for the interval is the smallest multiple of the current one whose means have a lag-1 autocorrelation under
+ * the threshold with at least MIN_BATCHES of them; until it exists the interval is infinite.
+ */
+class BatchMeansMeasure : public Measure<double>
+{
+  public:
+    static constexpr size_t MIN_BATCHES = 20;
+
+  private:
+    size_t _slots;
+    double _threshold;
+    double _confidence = 0.90;
+    size_t _warmup = 0;
+    size_t _discarded = 0;
+    size_t _batchSize = 1;
+    double _batchSum = 0.0;
+    size_t _batchCount = 0;
+    std::vector<double> _means{};
+
+    // averages adjacent batch means in pairs, an odd last one is dropped
+    void Compact();
+    // means of groups of group consecutive batches
+    std::vector<double> Grouped(size_t group) const;
+    // smallest group of batches whose means look independent, 0 if there is none yet
+    size_t SelectedGroup() const;
+
+  public:
+    BatchMeansMeasure(std::string name, std::string unit, size_t slots = 256, double threshold = 0.2);
+
+    BatchMeansMeasure() : BatchMeansMeasure("", "")
+    {
+    }
+
+    BatchMeansMeasure &WithConfidence(double confidence)
+    {
+        _confidence = confidence;
+        return *this;
+    }
+
+    // the first samples belong to the transitory period and are discarded
+    BatchMeansMeasure &WithWarmup(size_t samples)
+    {
+        _warmup = samples;
+        return *this;
+    }
+
+    void Accumulate(double value) override;
+    // mean of the completed batches
+    double mean() const;
+    // lag-k autocorrelation of the means of groups of group batches
+    double Autocorrelation(size_t lag, size_t group = 1) const;
+    Interval confidence() const;
+
+    bool Ready(double precision) const
+    {
+        return confidence().precision() <= precision;
+    }
+
+    // batch size of the interval, 0 until the batch means look independent
+    size_t BatchSize() const
+    {
+        return _batchSize * SelectedGroup();
+    }
+
+    size_t Batches() const
+    {
+        return _means.size();
+    }
+
+    // appends the batches of an independent run, after bringing both to the same batch size, without its partial batch
+    void Merge(const BatchMeansMeasure &other);
+    void Serialize(std::string &out) const;
+    bool Deserialize(std::string_view &in);
+
+    std::string Heading() override;
+    std::string Csv() override;
+    std::string Json() override;
+    void Reset() override;
+};
+
+template <> struct fmt::formatter<BatchMeansMeasure> : formatter<string_view>
+{
+    auto format(const BatchMeansMeasure &m, format_context &ctx) const -> format_context::iterator
+    {
+        auto interval = m.confidence();
+        return fmt::format_to(ctx.out(), "Measure: {}, R: {},LB:{}, HB:{}, Samples:{}, BatchSize:{}, Precision:{}",
+                              m.Name(), m.mean(), interval.lower(), interval.higher(), m.Count(), m.BatchSize(),
+                              interval.precision());
+    }
+};
+
 class MobileMeanMeasure : BaseMeasure
 {
     std::vector<double> _means;
@@ -442,16 +747,85 @@ class MobileMeanMeasure : BaseMeasure
     MobileMeanMeasure(int bufferSize, int maxMeans);
 };
 
+/**
+ * @brief Streaming MSER-5 detector of the end of the transitory period.
+ * @note Observations are averaged in batches of 5, the truncation point is the d minimising the variance of the mean
+ * of the batches after d, searched in the first half of the sequence. The search runs every time the batches grow by
+ * a quarter and uses prefix sums, so the work per observation is constant amortized. When maxBatches are reached the
+ * batches are averaged in pairs and the detector goes on as MSER-10, MSER-20 and so on. Once a truncation point is
+ * found before the half the transitory period is over and stays over until Reset.
+ */
+class WarmupDetector
+{
+  private:
+    size_t _initialBatchSize;
+    size_t _batchSize;
+    size_t _minBatches;
+    size_t _maxBatches;
+    size_t _observations = 0;
+    double _batchSum = 0.0;
+    size_t _batchCount = 0;
+    // prefix sums are taken around the first batch mean to keep the differences small
+    double _shift = 0.0;
+    std::vector<double> _means{};
+    std::vector<double> _prefix{0.0};
+    std::vector<double> _prefixSquares{0.0};
+    size_t _nextCheck;
+    bool _ended = false;
+    size_t _truncation = 0;
+
+    void Compact();
+    void Evaluate();
+
+  public:
+    WarmupDetector(size_t batchSize = 5, size_t minBatches = 10, size_t maxBatches = 4096);
+
+    void Push(double value);
+
+    bool Transitory() const
+    {
+        return !_ended;
+    }
+
+    // observations belonging to the transitory period, valid once it is over
+    size_t TruncationPoint() const
+    {
+        return _truncation;
+    }
+
+    size_t Observations() const
+    {
+        return _observations;
+    }
+
+    void Reset();
+};
+
+/**
+ * @brief Ratio estimator R = sum(values) / sum(times) of paired samples.
+ * @note Keeps the means of both series and the sums of the products of their deviations, updated as in Welford and
+ * merged as in Chan et al., so the variance of the residuals value - R * time is computed without cancellation.
+ */
 struct CovariatedMeasure : BaseMeasure
 {
     double _confidence = 0.95;
     double _precision = 0.05;
+    // normal quantile of the last confidence used, recomputed only when the confidence changes
+    mutable double _quantileConfidence = -1.0;
+    mutable double _quantile = 0.0;
     double _current[2]{};
-    double _sum[2]{};
-    double _times[2]{};
-    double _weightedsum{};
+    // means of values and times
+    double _mean[2]{};
+    // sum of (value - mean)^2, (time - mean)^2 and of their products
+    double _valueComoment{};
+    double _timeComoment{};
+    double _crossComoment{};
     virtual void Accumulate(double value, double time);
+    void Merge(const CovariatedMeasure &other);
+    void Serialize(std::string &out) const;
+    bool Deserialize(std::string_view &in);
 
+    // ratio of the means, NAN for an empty measure
     double R() const;
     double variance() const;
     Interval confidence() const;
@@ -488,22 +862,33 @@ struct CovariatedMeasure : BaseMeasure
 
     void Reset() override
     {
-        memset(_sum, 0, sizeof(double) * 2);
-        memset(_times, 0, sizeof(double) * 2);
-        _weightedsum = 0;
+        memset(_mean, 0, sizeof(double) * 2);
+        _valueComoment = 0;
+        _timeComoment = 0;
+        _crossComoment = 0;
         BaseMeasure::Reset();
     }
-    int SampleNeedsForPrecision();
+    // samples needed for the interval to reach _precision with the current variance, Count() included
+    int SampleNeedsForPrecision() const;
+    // same for a precision other than the one of the measure, which is left as it is
+    int SampleNeedsForPrecision(double precision) const;
 
+    // sum of the times for moment 0, of their squares for moment 1
     double times(int moment = 0)
     {
-        return _times[moment];
+        return moment == 0 ? _mean[1] * _count : _timeComoment + _mean[1] * _mean[1] * _count;
     }
 
+    // sum of the values for moment 0, of their squares for moment 1
     double sum(int moment = 0)
     {
-        return _sum[moment];
+        return moment == 0 ? _mean[0] * _count : _valueComoment + _mean[0] * _mean[0] * _count;
     }
+
+  private:
+    // sum of (value - R * time)^2, the mean residual is zero by definition of R
+    double residuals() const;
+    double quantile() const;
 };
 
 template <> struct fmt::formatter<CovariatedMeasure>
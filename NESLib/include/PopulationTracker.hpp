@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Time integrals of the number of customers in a station.
+ * @note The integrals are advanced only when the population changes, queries add the time elapsed since the last
+ * change, so events that leave the population as it is cost nothing. The histogram holds the time spent with exactly
+ * k customers and is updated by the same changes, it is kept by the caller so that the tracker stays trivially copyable.
+ */
+class PopulationTracker
+{
+  private:
+    double _start = 0.0;
+    double _lastChange = 0.0;
+    int _count = 0;
+    double _busyTime = 0.0;
+    double _area = 0.0;
+    double _queueArea = 0.0;
+
+    void Close(double clock, std::vector<double> &histogram)
+    {
+        double interval = clock - _lastChange;
+        _lastChange = clock;
+        if (_count > 0)
+        {
+            _busyTime += interval;
+            _area += _count * interval;
+            _queueArea += (_count - 1) * interval;
+        }
+        if (_count >= 0)
+        {
+            if ((size_t)_count >= histogram.size())
+                histogram.resize(_count + 1);
+            histogram[_count] += interval;
+        }
+    }
+
+    double Open(double clock) const
+    {
+        return clock - _lastChange;
+    }
+
+  public:
+    void Change(int delta, double clock, std::vector<double> &histogram)
+    {
+        Close(clock, histogram);
+        _count += delta;
+    }
+
+    void Set(int count, double clock, std::vector<double> &histogram)
+    {
+        Close(clock, histogram);
+        _count = count;
+    }
+
+    // starts a new observation period at clock, the population stays as it is and the histogram is cleared apart
+    void Reset(double clock)
+    {
+        _start = clock;
+        _lastChange = clock;
+        _busyTime = 0.0;
+        _area = 0.0;
+        _queueArea = 0.0;
+    }
+
+    int Count() const
+    {
+        return _count;
+    }
+
+    double Observation(double clock) const
+    {
+        return clock - _start;
+    }
+
+    double BusyTime(double clock) const
+    {
+        return _busyTime + (_count > 0 ? Open(clock) : 0.0);
+    }
+
+    double Area(double clock) const
+    {
+        return _area + (_count > 0 ? _count * Open(clock) : 0.0);
+    }
+
+    double QueueArea(double clock) const
+    {
+        return _queueArea + (_count > 0 ? (_count - 1) * Open(clock) : 0.0);
+    }
+
+    // time spent with exactly k customers, for every k seen so far
+    std::vector<double> Histogram(double clock, const std::vector<double> &closed) const
+    {
+        auto histogram = closed;
+        if (_count >= 0)
+        {
+            if ((size_t)_count >= histogram.size())
+                histogram.resize(_count + 1);
+            histogram[_count] += Open(clock);
+        }
+        return histogram;
+    }
+
+    // smallest population k such that the fraction of time spent with at most k customers is at least p
+    int Percentile(double p, double clock, const std::vector<double> &closed) const
+    {
+        auto histogram = Histogram(clock, closed);
+        double observation = Observation(clock);
+        double cumulated = 0.0;
+        for (size_t k = 0; k < histogram.size(); k++)
+        {
+            cumulated += histogram[k];
+            if (cumulated >= p * observation)
+                return k;
+        }
+        return histogram.size() - 1;
+    }
+};
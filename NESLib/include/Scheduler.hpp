@@ -1,63 +1,91 @@
 #pragma once
+#include "Collections/EventQueue.hpp"
 #include "Collections/LinkedList.hpp"
 #include "Event.hpp"
+#include "EventTrace.hpp"
 #include "ISimulator.hpp"
 #include "LogEngine.hpp"
 #include "Station.hpp"
+#include "StationTable.hpp"
 #include "Usings.hpp"
+#include "rngs.hpp"
 #include <memory>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class Scheduler : public IScheduler, public BaseStation
 {
   protected:
     std::vector<sptr<Station>> _stations{};
-    DoubleLinkedList<Event> _eventList{};
-    virtual bool Route(Event event);
+    std::vector<sptr<Station>> _routes{}; // indexed by stationIndex, empty for unused indexes
+    std::unordered_map<std::string, sptr<Station>> _names{};
+    std::unique_ptr<EventQueue> _eventList;
+    virtual bool Route(const Event &event);
     size_t processedEvents = 0;
+    uint64_t _customerIds = 0;
+    std::shared_ptr<NodePool<Event>> _eventNodes = std::make_shared<NodePool<Event>>();
+    // counters of the registered stations, the scheduler keeps its own apart
+    std::shared_ptr<StationTable> _stationTable = std::make_shared<StationTable>();
+    RandomStream *_generator;
+    std::unique_ptr<TraceWriter> _trace{};
+
+    void Register(sptr<Station> station);
+
+    // called on every dequeued event, a single check when no trace is recorded
+    void RecordEvent(const Event &event)
+    {
+        if (_trace != nullptr)
+            _trace->Write(event);
+    }
 
   public:
-    virtual void Schedule(Event event) override;
+    virtual void Schedule(const Event &event) override;
     virtual void Initialize();
 
     template <typename STAT> inline Scheduler &AddStation(STAT *station)
     {
-        _stations.push_back(sptr<STAT>(station));
+        Register(sptr<STAT>(station));
         return *this;
     };
 
-    Scheduler(std::string name) : BaseStation(name)
+    Scheduler(std::string name, EventQueueType queueType = EventQueueType::BINARY_HEAP,
+              RandomStream &generator = RandomStream::Global())
+        : BaseStation(name), _eventList(EventQueue::Create(queueType)), _generator(&generator)
     {
     }
 
+    void UseEventQueue(EventQueueType queueType);
+
+    // records every event dequeued from now on in a binary trace, see EventTrace.hpp
+    bool RecordTrace(std::string file);
+    void StopTrace();
+
     std::optional<sptr<Station>> GetStation(std::string name) override
     {
-        for (auto &st : _stations)
-        {
-            if (st->Name() == name)
-            {
-                return st;
-            }
-        }
-        return {};
+        auto itr = _names.find(name);
+        if (itr == _names.end())
+            return {};
+        return itr->second;
+    }
+
+    // slot i holds the counters of the station with slot() == i, Snapshot copies all of them at once
+    const StationTable &GetStationTable() const
+    {
+        return *_stationTable;
     }
 
-    const DoubleLinkedList<Event> EventQueue()
+    const EventQueue &GetEventQueue() const
     {
-        return _eventList;
+        return *_eventList;
     }
 
     std::optional<sptr<Station>> GetStation(int stationIndex) override
     {
-        for (auto s : _stations)
-        {
-            if (s->stationIndex() == stationIndex)
-            {
-                return s;
-            }
-        }
-        return {};
+        if (stationIndex < 0 || stationIndex >= (int)_routes.size() || _routes[stationIndex] == nullptr)
+            return {};
+        return _routes[stationIndex];
     }
 
     const std::vector<sptr<Station>> GetStations() const override
@@ -75,25 +103,36 @@ class Scheduler : public IScheduler, public BaseStation
         return GetStation(index);
     }
 
+    // brings every station to the clock of the scheduler, no event is processed and no station is touched
     void Sync() override
     {
-        LogLocker l{};
-        for (auto s : _stations)
-        {
-            auto e = Event("SYNC", PROBE, _clock, _clock, 0, _clock, s->stationIndex());
-            s->Process(e);
-        }
+        _stationTable->SyncTo(_clock);
     }
     Event ProcessNext();
     bool HasEvents() const
     {
-        return _eventList.Count() > 0;
+        return _eventList->Count() > 0;
     }
     double GetClock() override
     {
         return _clock;
     }
 
+    uint64_t NewCustomerId() override
+    {
+        return _customerIds++;
+    }
+
+    std::shared_ptr<NodePool<Event>> EventNodes() override
+    {
+        return _eventNodes;
+    }
+
+    RandomStream &Generator() override
+    {
+        return *_generator;
+    }
+
     void Reset() override;
     virtual Event Create(double interArrival, double serviceTime, int stationTarget = -1, EventType type = ARRIVAL);
 };
@@ -0,0 +1,66 @@
+#pragma once
+#include "Event.hpp"
+#include "Scheduler.hpp"
+#include "Station.hpp"
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Scheduler of a network whose station types are known at compile time.
+ * @note Events are routed with a switch over a variant of the listed types instead of the virtual Process, and
+ * BaseStation::ProcessAs then binds ProcessArrival, ProcessDeparture and the others statically for the types marked
+ * final. Stations added with a type that is not in the list are routed by the dynamic path of Scheduler, so models
+ * can still mix in any station.
+ */
+template <typename... Stations> class StaticScheduler : public Scheduler
+{
+  private:
+    using TypedStation = std::variant<std::monostate, Stations *...>;
+    std::vector<TypedStation> _static{}; // indexed by stationIndex like _routes
+
+    template <typename STAT> void Bind(STAT *station)
+    {
+        int index = station->stationIndex();
+        if (index < 0 || _routes[index].get() != station)
+            return;
+        if (index >= (int)_static.size())
+            _static.resize(index + 1);
+        _static[index] = station;
+    }
+
+  protected:
+    bool Route(const Event &event) final
+    {
+        if (event.Station < 0 || event.Station >= (int)_static.size() ||
+            std::holds_alternative<std::monostate>(_static[event.Station]))
+            return Scheduler::Route(event);
+        // stations work on their own copy, the caller keeps the event as it was dequeued
+        Event routed = event;
+        std::visit(
+            [&routed](auto station) {
+                if constexpr (!std::is_same_v<decltype(station), std::monostate>)
+                    BaseStation::ProcessAs(*station, routed);
+            },
+            _static[event.Station]);
+        return true;
+    }
+
+  public:
+    using Scheduler::Scheduler;
+
+    template <typename STAT> StaticScheduler &AddStation(STAT *station)
+    {
+        Scheduler::AddStation(station);
+        if constexpr ((std::is_same_v<STAT, Stations> || ...))
+            Bind(station);
+        return *this;
+    }
+
+    // true when events for the index skip the virtual calls
+    bool IsStatic(int stationIndex) const
+    {
+        return stationIndex >= 0 && stationIndex < (int)_static.size() &&
+               !std::holds_alternative<std::monostate>(_static[stationIndex]);
+    }
+};
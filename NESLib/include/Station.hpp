@@ -1,8 +1,16 @@
 #pragma once
+#include "Core.hpp"
 #include "DataCollector.hpp"
 #include "Event.hpp"
+#include "Hooks.hpp"
 #include "LogEngine.hpp"
-#include <functional>
+#include "Measure.hpp"
+#include "PopulationTracker.hpp"
+#include "StationTable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -16,157 +24,298 @@ class BaseStation
     TraceSource _logger;
     std::string _name;
 
-    int _arrivals{};
-    int _completions{};
-    int _sysClients{};
-    int _maxClients{};
-    double _busyTime{};
-    double _observationPeriod{};
-    double _lastArrival{};
-    double _areaN{};
-    double _areaS{};
-    double _oldclock{};
     double _clock{};
-    std::vector<std::function<void(BaseStation *, Event &)>> _onArrival;
-    std::vector<std::function<void(BaseStation *, Event &)>> _onDeparture;
+    // counters and time weighted statistics, evaluated up to the last event processed, in the table of the scheduler
+    std::shared_ptr<StationTable> _table = std::make_shared<StationTable>();
+    size_t _slot = _table->Add();
+    // record of the slot, an event reaches the counters with a single load
+    StationCounters *_counters = &(*_table)[_slot];
+    // time spent with exactly k customers up to the last population change
+    std::vector<double> _histogram{};
+    // response time of every completed visit, only while tracked
+    std::optional<QuantileMeasure> _responseTimes{};
+    double _lastResponse = NAN;
+    HookList<BaseStation *, Event &> _onArrival;
+    HookList<BaseStation *, Event &> _onDeparture;
+    HookList<BaseStation *, Event &> _onArrivalOnce;
+    HookList<BaseStation *, Event &> _onDepartureOnce;
+    HookId _lastHook = 0;
+
+    StationCounters &Counters()
+    {
+        return *_counters;
+    }
+
+    const StationCounters &Counters() const
+    {
+        return *_counters;
+    }
+
+    void ChangePopulation(int delta)
+    {
+        Counters().population.Change(delta, _clock, _histogram);
+    }
 
-    std::vector<std::function<void(BaseStation *, Event &)>> _onArrivalOnce;
-    std::vector<std::function<void(BaseStation *, Event &)>> _onDepartureOnce;
+    void SetPopulation(int count)
+    {
+        Counters().population.Set(count, _clock, _histogram);
+    }
 
   public:
     BaseStation(std::string name);
     virtual void Process(Event &event);
+
+    // body of Process, when STAT is a final class every step is bound at compile time, see StaticScheduler
+    template <typename STAT> static void ProcessAs(STAT &station, Event &event)
+    {
+        core_assert(event.OccurTime >= station._clock, "Event {} occur at a lesser time of {} in station {}", event,
+                    station._clock, station._name);
+        station._clock = event.OccurTime;
+        station._logger.Transfer("Processing:{}", event);
+        switch (event.Type)
+        {
+        case EventType::ARRIVAL:
+            station._logger.Transfer("Arrival:{}", event);
+            station._onArrival.Dispatch(&station, event);
+            if (!station._onArrivalOnce.Empty())
+                station._onArrivalOnce.DispatchOnce(&station, event);
+            station.ProcessArrival(event);
+            break;
+        case EventType::DEPARTURE:
+            station.ProcessDeparture(event);
+            station._onDeparture.Dispatch(&station, event);
+            if (!station._onDepartureOnce.Empty())
+                station._onDepartureOnce.DispatchOnce(&station, event);
+            station._logger.Transfer("Departure:{}", event);
+            break;
+        case EventType::NO_EVENT:
+            break;
+        case EventType::END:
+            station._logger.Transfer("End:{}", event);
+            station.ProcessEnd(event);
+            break;
+        case EventType::PROBE:
+            station.ProcessProbe(event);
+        }
+    }
+
+    // new observation period from the current clock, for the counters and for the state kept apart from the table
     virtual void Reset();
+    // state kept apart from the table, a scheduler resets the counters of all its stations at once and then calls it
+    virtual void ResetState();
+    // moves the counters to a slot of table, the scheduler calls it on every station it registers
+    void Attach(std::shared_ptr<StationTable> table);
+
+    // points again at the slot after the records of the table moved
+    void Rebind()
+    {
+        _counters = &(*_table)[_slot];
+    }
+
     std::string Name() const
     {
         return _name;
     }
 
+    size_t slot() const
+    {
+        return _slot;
+    }
+
     int arrivals() const
     {
-        return _arrivals;
+        return Counters().arrivals;
     }
 
     int completions() const
     {
-        return _completions;
+        return Counters().completions;
     }
 
     int sysClients() const
     {
-        return _sysClients;
+        return Counters().population.Count();
     }
     double observation() const
     {
-        return _observationPeriod;
+        return observation(clock());
     }
 
     double busyTime() const
     {
-        return _busyTime;
+        return busyTime(clock());
+    }
+
+    // the time weighted statistics as of a time not before the last event, nothing in the station changes
+    double observation(double at) const
+    {
+        return Counters().population.Observation(at);
+    }
+
+    double busyTime(double at) const
+    {
+        return Counters().population.BusyTime(at);
     }
 
+    double areaN(double at) const
+    {
+        return Counters().population.Area(at);
+    }
+
+    double areaS(double at) const
+    {
+        return Counters().population.QueueArea(at);
+    }
+
+    // time of the last event, or of the last sync of the scheduler when that came later
     double clock() const
     {
-        return _clock;
+        return std::max(_clock, _table->Synced());
+    }
+
+    // moves the clock of an idle station forward, the statistics are lazy so no event has to be processed
+    void AdvanceTo(double clock)
+    {
+        core_assert(clock >= _clock, "Station {} cannot go back from {} to {}", _name, _clock, clock);
+        _clock = clock;
     }
 
-    template <typename F> void OnDeparture(F &&fnc)
+    // starts sketching the response times of the customers arriving from now on, they are cleared on Reset
+    void TrackResponseTimes(double accuracy = 0.01)
     {
-        _onDeparture.push_back(fnc);
+        _responseTimes.emplace(_name + "_response", "", accuracy);
     }
 
-    template <typename F> void OnArrival(F &&fnc)
+    const QuantileMeasure *responseTimes() const
     {
-        _onArrival.push_back(fnc);
+        return _responseTimes.has_value() ? &_responseTimes.value() : nullptr;
     }
 
-    template <typename F> void OnArrivalOnce(F &&fnc)
+    // response time of the visit that just ended, valid in the departure callbacks of tracked stations
+    double lastResponseTime() const
     {
-        _onArrivalOnce.push_back(fnc);
+        return _lastResponse;
     }
 
-    template <typename F> void OnDepartureOnce(F &&fnc)
+    // the hooks return an id that RemoveHook takes, it stays valid until the hook is removed or fired once
+    template <typename F> HookId OnDeparture(F &&fnc)
     {
-        _onDepartureOnce.push_back(fnc);
+        _onDeparture.Add(++_lastHook, std::forward<F>(fnc));
+        return _lastHook;
+    }
+
+    template <typename F> HookId OnArrival(F &&fnc)
+    {
+        _onArrival.Add(++_lastHook, std::forward<F>(fnc));
+        return _lastHook;
+    }
+
+    template <typename F> HookId OnArrivalOnce(F &&fnc)
+    {
+        _onArrivalOnce.Add(++_lastHook, std::forward<F>(fnc));
+        return _lastHook;
+    }
+
+    template <typename F> HookId OnDepartureOnce(F &&fnc)
+    {
+        _onDepartureOnce.Add(++_lastHook, std::forward<F>(fnc));
+        return _lastHook;
+    }
+
+    // safe from inside a hook, false if the id is not pending on this station
+    bool RemoveHook(HookId id)
+    {
+        return _onArrival.Remove(id) || _onDeparture.Remove(id) || _onArrivalOnce.Remove(id) ||
+               _onDepartureOnce.Remove(id);
     }
 
     double avg_interArrival() const
     {
-        return _observationPeriod / _arrivals;
+        return observation() / arrivals();
     }
 
     double avg_serviceTime() const
     {
-        return _busyTime / _completions;
+        return busyTime() / completions();
     }
 
     double avg_delay() const
     {
-        return _areaS / _completions;
+        return areaS() / completions();
     }
 
     double avg_waiting() const
     {
-        return _areaN / _completions;
+        return areaN() / completions();
     }
 
     double utilization() const
     {
-        return _busyTime / _observationPeriod;
+        return busyTime() / observation();
     }
 
     int max_sys_clients()
     {
-        return _maxClients;
+        return Counters().maxClients;
     }
 
     double throughput() const
     {
-        return _completions / _observationPeriod;
+        return completions() / observation();
     }
 
     double input_rate() const
     {
-        return _arrivals / _observationPeriod;
+        return arrivals() / observation();
     }
 
     double arrival_rate() const
     {
-        return _arrivals / _observationPeriod;
+        return arrivals() / observation();
     }
 
     double service_rate() const
     {
-        return _completions / _busyTime;
+        return completions() / busyTime();
     }
 
     double traffic() const
     {
-        return _busyTime / _lastArrival;
+        return busyTime() / Counters().lastArrival;
     }
 
     double mean_customer_queue() const
     {
-        return _areaS / _observationPeriod;
+        return areaS() / observation();
     }
     double mean_customer_service() const
     {
-        return _busyTime / _completions;
+        return busyTime() / completions();
     }
 
     double mean_customer_system() const
     {
-        return _areaN / _observationPeriod;
+        return areaN() / observation();
     }
 
     double areaN() const
     {
-        return _areaN;
+        return areaN(clock());
     }
     double areaS() const
     {
-        return _areaS;
+        return areaS(clock());
+    }
+
+    // time spent with exactly k customers in the station
+    std::vector<double> population_histogram() const
+    {
+        return Counters().population.Histogram(clock(), _histogram);
+    }
+
+    int population_percentile(double p) const
+    {
+        return Counters().population.Percentile(p, clock(), _histogram);
     }
 };
 
@@ -178,7 +327,7 @@ class Station : public BaseStation
 
   public:
     virtual void Initialize();
-    virtual void Reset() override;
+    virtual void ResetState() override;
     Station(std::string name, int station);
 
     int stationIndex() const
@@ -0,0 +1,97 @@
+#pragma once
+#include "PopulationTracker.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// every counter a station updates on an event, in one record so that an event touches a single cache line or two
+struct StationCounters
+{
+    int arrivals = 0;
+    int completions = 0;
+    int maxClients = 0;
+    double lastArrival = 0.0;
+    PopulationTracker population{};
+
+    void Reset(double clock)
+    {
+        arrivals = 0;
+        completions = 0;
+        maxClients = 0;
+        lastArrival = 0.0;
+        population.Reset(clock);
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<StationCounters>, "a snapshot of the table must be a plain copy");
+
+/**
+ * @brief Counters of all the stations of a simulation stored in one contiguous block.
+ * @note The scheduler owns the table and every station it registers keeps a slot in it, so walking the statistics of
+ * the whole network reads sequential memory instead of one heap object per station, and a snapshot is a single copy
+ * that can be handed to another thread. A station outside a scheduler owns a table of its own.
+ */
+class StationTable
+{
+  private:
+    std::vector<StationCounters> _counters{};
+    double _synced = 0.0;
+
+  public:
+    // the slot of the new station, the counters are copied when a station moves from another table; the records may
+    // move, the stations of the table have to Rebind
+    size_t Add(const StationCounters &counters = {})
+    {
+        _counters.push_back(counters);
+        return _counters.size() - 1;
+    }
+
+    StationCounters &operator[](size_t slot)
+    {
+        return _counters[slot];
+    }
+
+    const StationCounters &operator[](size_t slot) const
+    {
+        return _counters[slot];
+    }
+
+    size_t Size() const
+    {
+        return _counters.size();
+    }
+
+    const StationCounters *begin() const
+    {
+        return _counters.data();
+    }
+
+    const StationCounters *end() const
+    {
+        return _counters.data() + _counters.size();
+    }
+
+    std::vector<StationCounters> Snapshot() const
+    {
+        return _counters;
+    }
+
+    // clock every station of the table is read at when its last event came earlier, see BaseStation::clock
+    double Synced() const
+    {
+        return _synced;
+    }
+
+    // the statistics are lazy, bringing all the stations to clock is a single store
+    void SyncTo(double clock)
+    {
+        _synced = clock;
+    }
+
+    // starts a new observation period at clock for every slot
+    void Reset(double clock)
+    {
+        for (auto &counters : _counters)
+            counters.Reset(clock);
+    }
+};
@@ -17,6 +17,8 @@ struct RegenerationPoint
   private:
     int _called = 0;
     int _hitted = 0;
+    // customers the rules pin on stations
+    int _clients = 0;
     bool _rulesEnabled = true;
   public:
     IScheduler *scheduler;
@@ -62,12 +64,22 @@ struct RegenerationPoint
     {
         return _called;
     }
+    // the rules pin clients customers on some station, a network with fewer customers never regenerates
+    void RequireClients(int clients)
+    {
+        _clients += clients;
+    }
+    int requiredClients() const
+    {
+        return _clients;
+    }
     void Reset()
     {
         _rules.clear();
         _actions.clear();
         _hitted = 0;
         _called = 0;
+        _clients = 0;
     }
     void SetRules(bool enable){_rulesEnabled = enable;}
 };
\ No newline at end of file
@@ -8,14 +8,24 @@
 #include <map>
 #include <optional>
 #include <utility>
+#include <vector>
 struct TaggedCustomer
 {
-    MobileMeanMeasure _transitory{10, 10};
+    // fed with the mean cycle time of every regeneration cycle
+    WarmupDetector _transitory{};
+    // sum and count of the cycles pushed to the detector and their cycle times, replayed from the truncation point
+    // once the transitory period is over
+    std::vector<std::pair<double, size_t>> _pendingCycles{};
+    std::vector<double> _pendingIntervals{};
     CovariatedMeasure _mean{"cycleTime", "ms"};
     Accumulator<> _acc{"regTime", "ms"};
+    // every cycle time after the transitory period
+    QuantileMeasure _quantiles{"cycleTime", "ms"};
+    // every cycle time after the transitory period, for the estimators that do not rely on regeneration cycles
+    BatchMeansMeasure _batches{"cycleTime", "ms"};
     std::optional<std::function<void(Event &)>> _onEntrance;
     std::optional<std::function<void(Event &)>> _onLeave;
-    std::string target_client = "";
+    std::optional<uint64_t> target_client{};
     TaggedCustomer()
     {
     }
@@ -31,6 +41,10 @@ struct TaggedCustomer
     void ConnectLeave(BaseStation *station, bool arrival = false);
     void CompleteRegCycle(double actualClock);
     void CompleteSimulation();
+    // a new run starts, the transitory period has to be detected again
+    void RestartWarmup();
+    // collects the cycles after the truncation point, called when the detector ends the transitory period
+    void ReplayWarmCycles();
 
     template <typename F>
         requires(has_return_value<F, void, Event &>)
@@ -1,8 +1,9 @@
 #pragma once
 #include "Collections/LinkedList.hpp"
+#include "Collections/NodePool.hpp"
 #include "Event.hpp"
 #include <memory>
 
 template <typename T> using sptr = std::shared_ptr<T>;
 
-using EventList = DoubleLinkedList<Event>;
\ No newline at end of file
+using EventList = DoubleLinkedList<Event, PooledNodeAllocator<Event>>;
\ No newline at end of file
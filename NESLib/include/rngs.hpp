@@ -6,8 +6,11 @@
  */
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 #include <vector>
 #define MODULUS 2147483647 /* DON'T CHANGE THIS VALUE                  */
 #define MULTIPLIER 48271   /* DON'T CHANGE THIS VALUE                  */
@@ -16,32 +19,111 @@
 #define A256 22925         /* jump multiplier, DON'T CHANGE THIS VALUE */
 #define DEFAULT 123456789  /* initial seed, use 0 < DEFAULT < MODULUS  */
 
-class RandomStream;
+class VariableStream;
+
+enum class RandomEngine : int
+{
+    LEHMER,      // Park & Miller, 256 streams 8,367,782 draws apart, reproduces the published results
+    XOSHIRO256PP // xoshiro256++, unlimited streams 2^128 draws apart
+};
 
 struct BaseStream
 {
     virtual double operator()() = 0;
 };
 
+class RandomStream
+{
+    long seed[STREAMS] = {DEFAULT}; /* current state of each stream   */
+    int stream = 0;                 /* stream index, 0 is the default */
+    int initialized = 0;            /* test for stream initialization */
+    int generatedStreams = 0;
+    RandomEngine engine = RandomEngine::LEHMER;
+    std::vector<std::array<uint64_t, 4>> xoshiro{}; /* xoshiro streams, split on demand */
+    long long draws[STREAMS] = {};  /* Lehmer draws of each stream since the seeds were planted */
+
+    double NextXoshiro();
+    void SplitXoshiro();
+
+  public:
+    bool antitethic = false;
+
+    RandomStream()
+    {
+    }
+    RandomStream(RandomEngine engine)
+    {
+        UseEngine(engine);
+    }
+    double Random(void);
+    void Fill(std::span<double> out);
+    void UseEngine(RandomEngine engine);
+    RandomEngine Engine() const
+    {
+        return engine;
+    }
+    void LongJump();
+    void PlantSeeds(long x);
+    void GetSeed(long *x);
+    void PutSeed(long x);
+    // full state of the current stream, the Lehmer seed is the first word
+    std::array<uint64_t, 4> GetState() const;
+    void PutState(const std::array<uint64_t, 4> &state);
+    void SelectStream(int index);
+    void SetAntitetich(bool value)
+    {
+        antitethic = value;
+    }
+    static RandomStream &Global();
+    static long Jump(long seed, long long draws);
+    // most numbers drawn from a single Lehmer stream since the last PlantSeeds
+    long long MaxDraws() const;
+    std::unique_ptr<VariableStream> GetStream(std::function<double(RandomStream &)> lambda);
+};
+
+// stream objects draw from the generator they are built with, the process wide Global() when none is given
 class VariableStream : public BaseStream
 {
     int stream;
+    RandomStream *_generator;
     std::function<double(RandomStream &)> _lambda;
+    std::function<void(std::span<double>, RandomStream &)> _batch{};
+    std::vector<double> _buffer{};
+    size_t _next = 0;
 
   public:
     double operator()() override;
     VariableStream(int stream, std::function<double(RandomStream &)> lambda);
+    VariableStream(RandomStream &generator, int stream, std::function<double(RandomStream &)> lambda);
+
+    /**
+     * @brief Serves the draws from a buffer of the given size, refilled by batch when it runs out.
+     * @note batch must produce the same values as size calls to the scalar lambda, the sequence then matches the
+     * unbuffered one as long as no other object draws from the same stream of the generator.
+     */
+    VariableStream &WithBuffer(size_t size, std::function<void(std::span<double>, RandomStream &)> batch);
 };
 
+// running sums of the weights, computed once so that a choice is a single search
+std::vector<double> CumulativeWeights(const std::vector<double> &weights);
+
 struct CompositionStream : public BaseStream
 {
     std::vector<std::function<double(RandomStream &)>> _generators{};
     std::vector<double> _alpha;
+    std::vector<double> _cdf;
     double operator()() override;
     int _stream;
+    RandomStream *_generator;
     template <typename... F>
     CompositionStream(int stream, std::vector<double> weights, F &&...fncs)
-        : _generators({fncs...}), _alpha(weights), _stream(stream)
+        : CompositionStream(RandomStream::Global(), stream, weights, std::forward<F>(fncs)...)
+    {
+    }
+    template <typename... F>
+    CompositionStream(RandomStream &generator, int stream, std::vector<double> weights, F &&...fncs)
+        : _generators({fncs...}), _alpha(weights), _cdf(CumulativeWeights(weights)), _stream(stream),
+          _generator(&generator)
     {
     }
 };
@@ -50,33 +132,10 @@ struct Router
 {
     std::vector<int> _indexes;
     std::vector<double> _p;
+    std::vector<double> _cdf;
     int operator()();
     int _stream{};
+    RandomStream *_generator;
     Router(int stream, std::vector<double> probs, std::vector<int> indexes);
-};
-
-class RandomStream
-{
-    long seed[STREAMS] = {DEFAULT}; /* current state of each stream   */
-    int stream = 0;                 /* stream index, 0 is the default */
-    int initialized = 0;            /* test for stream initialization */
-    int generatedStreams = 0;
-
-  public:
-    bool antitethic = false;
-
-    RandomStream()
-    {
-    }
-    double Random(void);
-    void PlantSeeds(long x);
-    void GetSeed(long *x);
-    void PutSeed(long x);
-    void SelectStream(int index);
-    void SetAntitetich(bool value)
-    {
-        antitethic = value;
-    }
-    static RandomStream &Global();
-    std::unique_ptr<VariableStream> GetStream(std::function<double(RandomStream &)> lambda);
+    Router(RandomStream &generator, int stream, std::vector<double> probs, std::vector<int> indexes);
 };
@@ -9,19 +9,34 @@
 #if !defined(_RVGS_)
 #define _RVGS_
 
-long Bernoulli(double p);
-long Binomial(long n, double p);
-long Equilikely(long a, long b);
-long Geometric(double p);
-long Pascal(long n, double p);
-long Poisson(double m);
+#include "rngs.hpp"
+#include <span>
+#include <vector>
 
-double Uniform(double a, double b);
-double Exponential(double m);
-double Erlang(long n, double b);
-double Normal(double m, double s);
-double Lognormal(double a, double b);
-double Chisquare(long n);
-double Student(long n);
+// every variate draws from rng, the process wide stream unless a simulation passes its own
+
+long Bernoulli(double p, RandomStream &rng = RandomStream::Global());
+long Binomial(long n, double p, RandomStream &rng = RandomStream::Global());
+long Equilikely(long a, long b, RandomStream &rng = RandomStream::Global());
+long Geometric(double p, RandomStream &rng = RandomStream::Global());
+long Pascal(long n, double p, RandomStream &rng = RandomStream::Global());
+long Poisson(double m, RandomStream &rng = RandomStream::Global());
+
+double Uniform(double a, double b, RandomStream &rng = RandomStream::Global());
+double Exponential(double m, RandomStream &rng = RandomStream::Global());
+double Erlang(long n, double b, RandomStream &rng = RandomStream::Global());
+double Normal(double m, double s, RandomStream &rng = RandomStream::Global());
+double Lognormal(double a, double b, RandomStream &rng = RandomStream::Global());
+double Chisquare(long n, RandomStream &rng = RandomStream::Global());
+double Student(long n, RandomStream &rng = RandomStream::Global());
+
+// batch variates, out gets the same values as out.size() calls to the scalar version on the same stream
+void Uniform(double a, double b, std::span<double> out, RandomStream &rng = RandomStream::Global());
+void Exponential(double m, std::span<double> out, RandomStream &rng = RandomStream::Global());
+// draws is a scratch buffer of the caller, grown to n * out.size() and reused across calls
+void Erlang(long n, double b, std::span<double> out, std::vector<double> &draws,
+            RandomStream &rng = RandomStream::Global());
+void Normal(double m, double s, std::span<double> out, RandomStream &rng = RandomStream::Global());
+void Lognormal(double a, double b, std::span<double> out, RandomStream &rng = RandomStream::Global());
 
 #endif
@@ -6,10 +6,10 @@
 void DelayStation::Initialize()
 {
     Station::Initialize();
-    _sysClients = _numclients();
+    SetPopulation(_numclients());
     for (int i = 0; i < _numclients(); i++)
     {
-        auto evt = Event(fmt::format("{}", Event::GeneratedNodes), DEPARTURE, _clock, _delayTime(), 0, 0, 0);
+        auto evt = Event(_scheduler->NewCustomerId(), DEPARTURE, _clock, _delayTime(), 0, 0, 0);
         _scheduler->Schedule(evt);
     }
 }
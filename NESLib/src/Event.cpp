@@ -1,9 +1,47 @@
 #include "Event.hpp"
+#include <fmt/core.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-int Event::DeletedNodes = 0;
+struct NameTable
+{
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint64_t> ids;
 
-int Event::GeneratedNodes = 0;
-bool Event::operator==(Event& oth) {
-    return Name == oth.Name&& OccurTime == oth.OccurTime
-    && Type == oth.Type;
+    static NameTable &Instance()
+    {
+        static NameTable instance{};
+        return instance;
+    }
+};
+
+uint64_t EventNames::Intern(std::string_view name)
+{
+    auto &table = NameTable::Instance();
+    std::lock_guard<std::mutex> lock{table.mutex};
+    auto itr = table.ids.find(std::string(name));
+    if (itr != table.ids.end())
+        return itr->second;
+    uint64_t id = NAMED | table.names.size();
+    table.names.emplace_back(name);
+    table.ids.emplace(std::string(name), id);
+    return id;
+}
+
+std::string EventNames::Lookup(uint64_t id)
+{
+    if (!IsNamed(id))
+        return fmt::format("J{}", id);
+    auto &table = NameTable::Instance();
+    std::lock_guard<std::mutex> lock{table.mutex};
+    auto index = id & ~NAMED;
+    return index < table.names.size() ? table.names[index] : fmt::format("N{}", index);
+}
+
+bool Event::operator==(const Event &oth) const
+{
+    return Id == oth.Id && OccurTime == oth.OccurTime && Type == oth.Type;
 }
@@ -0,0 +1,366 @@
+#include "Collections/EventQueue.hpp"
+#include "Core.hpp"
+#include "Event.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/core.h>
+#include <memory>
+#include <vector>
+
+std::unique_ptr<EventQueue> EventQueue::Create(EventQueueType type)
+{
+    switch (type)
+    {
+    case EventQueueType::SORTED_LIST:
+        return std::make_unique<SortedListQueue>();
+    case EventQueueType::BINARY_HEAP:
+        return std::make_unique<BinaryHeapQueue>();
+    case EventQueueType::PAIRING_HEAP:
+        return std::make_unique<PairingHeapQueue>();
+    case EventQueueType::CALENDAR:
+        return std::make_unique<CalendarQueue>();
+    }
+    panic(fmt::format("Unknown event queue type {}", (int)type));
+    return nullptr;
+}
+
+// region SortedListQueue
+
+void SortedListQueue::Insert(const Event &event)
+{
+    _list.Insert(event, [](const Event &a, const Event &b) { return a.OccurTime > b.OccurTime; });
+}
+
+Event SortedListQueue::Dequeue()
+{
+    return _list.Dequeue();
+}
+
+const Event &SortedListQueue::Peek() const
+{
+    if (_list.Count() == 0)
+        panic("Tryed to peek from the event queue but is empty");
+    return _list.begin().const_value();
+}
+
+void SortedListQueue::Clear()
+{
+    _list.Clear();
+}
+
+std::vector<Event> SortedListQueue::Ordered() const
+{
+    std::vector<Event> result{};
+    if (_list.Count() == 0)
+        return result;
+    auto itr = _list.begin();
+    while (itr != _list.end())
+    {
+        result.push_back(itr.const_value());
+        itr++;
+    }
+    result.push_back(itr.const_value());
+    return result;
+}
+
+SortedListQueue::~SortedListQueue()
+{
+    _list.Clear();
+}
+
+// endregion
+
+// region BinaryHeapQueue
+
+void BinaryHeapQueue::Insert(const Event &event)
+{
+    _heap.push_back(MakeEntry(event));
+    std::push_heap(_heap.begin(), _heap.end(), [](const Entry &a, const Entry &b) { return b < a; });
+}
+
+Event BinaryHeapQueue::Dequeue()
+{
+    if (_heap.empty())
+        panic("Tryed to dequeue from the event queue but is empty");
+    std::pop_heap(_heap.begin(), _heap.end(), [](const Entry &a, const Entry &b) { return b < a; });
+    Event result = _heap.back().event;
+    _heap.pop_back();
+    return result;
+}
+
+const Event &BinaryHeapQueue::Peek() const
+{
+    if (_heap.empty())
+        panic("Tryed to peek from the event queue but is empty");
+    return _heap.front().event;
+}
+
+void BinaryHeapQueue::Clear()
+{
+    _heap.clear();
+}
+
+std::vector<Event> BinaryHeapQueue::Ordered() const
+{
+    std::vector<Entry> entries{_heap};
+    std::sort(entries.begin(), entries.end());
+    std::vector<Event> result{};
+    for (auto &e : entries)
+        result.push_back(e.event);
+    return result;
+}
+
+// endregion
+
+// region PairingHeapQueue
+
+int PairingHeapQueue::Meld(int a, int b)
+{
+    if (a == NIL)
+        return b;
+    if (b == NIL)
+        return a;
+    if (_nodes[b].entry < _nodes[a].entry)
+        std::swap(a, b);
+    _nodes[b].sibling = _nodes[a].child;
+    _nodes[a].child = b;
+    return a;
+}
+
+int PairingHeapQueue::MergePairs(int first)
+{
+    // two pass merge: meld siblings pairwise from the left, then fold the pairs from the right
+    _pairs.clear();
+    while (first != NIL)
+    {
+        int a = first;
+        int b = _nodes[a].sibling;
+        first = b == NIL ? NIL : _nodes[b].sibling;
+        _nodes[a].sibling = NIL;
+        if (b != NIL)
+            _nodes[b].sibling = NIL;
+        _pairs.push_back(Meld(a, b));
+    }
+    int result = NIL;
+    for (auto itr = _pairs.rbegin(); itr != _pairs.rend(); ++itr)
+        result = Meld(*itr, result);
+    return result;
+}
+
+void PairingHeapQueue::Insert(const Event &event)
+{
+    int index;
+    if (_free.empty())
+    {
+        index = (int)_nodes.size();
+        _nodes.push_back(PNode{MakeEntry(event), NIL, NIL});
+    }
+    else
+    {
+        index = _free.back();
+        _free.pop_back();
+        _nodes[index] = PNode{MakeEntry(event), NIL, NIL};
+    }
+    _root = Meld(_root, index);
+    _count++;
+}
+
+Event PairingHeapQueue::Dequeue()
+{
+    if (_root == NIL)
+        panic("Tryed to dequeue from the event queue but is empty");
+    int old = _root;
+    Event result = _nodes[old].entry.event;
+    _root = MergePairs(_nodes[old].child);
+    _free.push_back(old);
+    _count--;
+    return result;
+}
+
+const Event &PairingHeapQueue::Peek() const
+{
+    if (_root == NIL)
+        panic("Tryed to peek from the event queue but is empty");
+    return _nodes[_root].entry.event;
+}
+
+void PairingHeapQueue::Clear()
+{
+    _nodes.clear();
+    _free.clear();
+    _root = NIL;
+    _count = 0;
+}
+
+std::vector<Event> PairingHeapQueue::Ordered() const
+{
+    std::vector<Entry> entries{};
+    std::vector<int> stack{};
+    if (_root != NIL)
+        stack.push_back(_root);
+    while (!stack.empty())
+    {
+        int n = stack.back();
+        stack.pop_back();
+        entries.push_back(_nodes[n].entry);
+        if (_nodes[n].child != NIL)
+            stack.push_back(_nodes[n].child);
+        if (_nodes[n].sibling != NIL)
+            stack.push_back(_nodes[n].sibling);
+    }
+    std::sort(entries.begin(), entries.end());
+    std::vector<Event> result{};
+    for (auto &e : entries)
+        result.push_back(e.event);
+    return result;
+}
+
+// endregion
+
+// region CalendarQueue
+
+CalendarQueue::CalendarQueue() : _buckets(MIN_BUCKETS)
+{
+}
+
+long long CalendarQueue::Year(double time) const
+{
+    return (long long)std::floor(time / _width);
+}
+
+size_t CalendarQueue::BucketOf(long long year) const
+{
+    long long n = (long long)_buckets.size();
+    return (size_t)(((year % n) + n) % n);
+}
+
+void CalendarQueue::Place(const Slot &slot)
+{
+    auto &bucket = _buckets[BucketOf(slot.year)];
+    // descending order, an entry goes in front of every entry that leaves before it
+    auto pos = std::upper_bound(bucket.begin(), bucket.end(), slot,
+                                [](const Slot &a, const Slot &b) { return b.entry < a.entry; });
+    bucket.insert(pos, slot);
+}
+
+size_t CalendarQueue::Locate() const
+{
+    // every pending entry has year >= _current, so the back of the current bucket is the minimum
+    // when it belongs to the current year
+    for (size_t i = 0; i < _buckets.size(); i++)
+    {
+        auto &bucket = _buckets[BucketOf(_current)];
+        if (!bucket.empty() && bucket.back().year == _current)
+            return BucketOf(_current);
+        _current++;
+    }
+    // empty year: jump straight to the earliest entry
+    const Slot *min = nullptr;
+    for (auto &bucket : _buckets)
+    {
+        if (!bucket.empty() && (min == nullptr || bucket.back().entry < min->entry))
+            min = &bucket.back();
+    }
+    _current = min->year;
+    return BucketOf(_current);
+}
+
+double CalendarQueue::EstimateWidth()
+{
+    size_t samples = std::min<size_t>(_scratch.size(), 25);
+    if (samples < 2)
+        return _width;
+    std::partial_sort(_scratch.begin(), _scratch.begin() + samples, _scratch.end(),
+                      [](const Slot &a, const Slot &b) { return a.entry < b.entry; });
+    double first = _scratch[0].entry.event.OccurTime;
+    double avg = (_scratch[samples - 1].entry.event.OccurTime - first) / (samples - 1);
+    double sum = 0;
+    int used = 0;
+    for (size_t i = 1; i < samples; i++)
+    {
+        double sep = _scratch[i].entry.event.OccurTime - _scratch[i - 1].entry.event.OccurTime;
+        if (sep <= 2 * avg)
+        {
+            sum += sep;
+            used++;
+        }
+    }
+    double width = used > 0 ? 3 * (sum / used) : 0;
+    return width > 0 && std::isfinite(width) ? width : _width;
+}
+
+void CalendarQueue::Resize(size_t buckets)
+{
+    _scratch.clear();
+    for (auto &bucket : _buckets)
+    {
+        _scratch.insert(_scratch.end(), bucket.begin(), bucket.end());
+        bucket.clear();
+    }
+    _width = EstimateWidth();
+    _buckets.resize(buckets);
+    _current = 0;
+    bool first = true;
+    for (auto &slot : _scratch)
+    {
+        slot.year = Year(slot.entry.event.OccurTime);
+        if (first || slot.year < _current)
+            _current = slot.year;
+        first = false;
+        Place(slot);
+    }
+}
+
+void CalendarQueue::Insert(const Event &event)
+{
+    Slot slot{MakeEntry(event), Year(event.OccurTime)};
+    if (_count == 0 || slot.year < _current)
+        _current = slot.year;
+    Place(slot);
+    _count++;
+    if (_count > 2 * _buckets.size())
+        Resize(2 * _buckets.size());
+}
+
+Event CalendarQueue::Dequeue()
+{
+    if (_count == 0)
+        panic("Tryed to dequeue from the event queue but is empty");
+    auto &bucket = _buckets[Locate()];
+    Event result = bucket.back().entry.event;
+    bucket.pop_back();
+    _count--;
+    if (_count < _buckets.size() / 2 && _buckets.size() > MIN_BUCKETS)
+        Resize(_buckets.size() / 2);
+    return result;
+}
+
+const Event &CalendarQueue::Peek() const
+{
+    if (_count == 0)
+        panic("Tryed to peek from the event queue but is empty");
+    return _buckets[Locate()].back().entry.event;
+}
+
+void CalendarQueue::Clear()
+{
+    for (auto &bucket : _buckets)
+        bucket.clear();
+    _count = 0;
+    _current = 0;
+}
+
+std::vector<Event> CalendarQueue::Ordered() const
+{
+    std::vector<Entry> entries{};
+    for (auto &bucket : _buckets)
+        for (auto &slot : bucket)
+            entries.push_back(slot.entry);
+    std::sort(entries.begin(), entries.end());
+    std::vector<Event> result{};
+    for (auto &e : entries)
+        result.push_back(e.event);
+    return result;
+}
+
+// endregion
@@ -0,0 +1,164 @@
+#include "EventTrace.hpp"
+#include "Event.hpp"
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+TraceWriter::TraceWriter(const std::string &path, const TraceStations &stations)
+    : _buffer(new TraceRecord[BUFFER_SIZE])
+{
+    _file = std::fopen(path.c_str(), "wb");
+    if (_file == nullptr)
+        return;
+    TraceHeader header{};
+    memcpy(header.magic, TraceHeader::MAGIC, sizeof(header.magic));
+    header.version = TraceHeader::VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.stations = stations.size();
+    std::fwrite(&header, sizeof(header), 1, _file);
+    for (auto &[index, name] : stations)
+    {
+        int32_t stationIndex = index;
+        uint32_t length = name.size();
+        std::fwrite(&stationIndex, sizeof(stationIndex), 1, _file);
+        std::fwrite(&length, sizeof(length), 1, _file);
+        std::fwrite(name.data(), 1, length, _file);
+    }
+}
+
+void TraceWriter::Flush()
+{
+    if (_file != nullptr && _count > 0)
+        std::fwrite(_buffer.get(), sizeof(TraceRecord), _count, _file);
+    _written += _count;
+    _count = 0;
+}
+
+TraceWriter::~TraceWriter()
+{
+    Flush();
+    if (_file != nullptr)
+        std::fclose(_file);
+}
+
+TraceReader::TraceReader(const std::string &path)
+{
+    _file = std::fopen(path.c_str(), "rb");
+    if (_file == nullptr)
+        return;
+    TraceHeader header{};
+    bool valid = std::fread(&header, sizeof(header), 1, _file) == 1 &&
+                 memcmp(header.magic, TraceHeader::MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == TraceHeader::VERSION && header.recordSize == sizeof(TraceRecord);
+    for (uint32_t i = 0; valid && i < header.stations; i++)
+    {
+        int32_t index;
+        uint32_t length;
+        valid = std::fread(&index, sizeof(index), 1, _file) == 1 && std::fread(&length, sizeof(length), 1, _file) == 1;
+        std::string name(valid ? length : 0, '\0');
+        valid = valid && std::fread(name.data(), 1, length, _file) == length;
+        _stations.emplace_back(index, name);
+    }
+    if (!valid)
+    {
+        std::fclose(_file);
+        _file = nullptr;
+        _stations.clear();
+        return;
+    }
+    _firstRecord = std::ftell(_file);
+    std::fseek(_file, 0, SEEK_END);
+    _count = (std::ftell(_file) - _firstRecord) / sizeof(TraceRecord);
+}
+
+TraceReader::~TraceReader()
+{
+    if (_file != nullptr)
+        std::fclose(_file);
+}
+
+size_t TraceReader::Read(size_t first, TraceRecord *out, size_t count)
+{
+    if (_file == nullptr || first >= _count)
+        return 0;
+    std::fseek(_file, _firstRecord + (long)(first * sizeof(TraceRecord)), SEEK_SET);
+    return std::fread(out, sizeof(TraceRecord), count, _file);
+}
+
+static bool IsMovement(const TraceRecord &record)
+{
+    return record.Station >= 0 && (record.Type == EventType::ARRIVAL || record.Type == EventType::DEPARTURE);
+}
+
+std::map<int, TraceStationStats> ReplayTrace(TraceReader &reader)
+{
+    constexpr size_t CHUNK = 4096;
+    std::map<int, TraceStationStats> stats{};
+    for (auto &[index, name] : reader.Stations())
+        stats[index].name = name;
+    size_t count = reader.Count();
+    std::vector<TraceRecord> chunk(CHUNK);
+
+    // backward pass, a departure followed by another departure of the same customer from the same station is a
+    // preemption and not a completion
+    std::vector<bool> completion(count, false);
+    std::unordered_map<uint64_t, TraceRecord> next{};
+    for (size_t end = count; end > 0;)
+    {
+        size_t first = end > CHUNK ? end - CHUNK : 0;
+        size_t read = reader.Read(first, chunk.data(), end - first);
+        for (size_t i = read; i > 0; i--)
+        {
+            auto &record = chunk[i - 1];
+            if (!IsMovement(record))
+                continue;
+            auto itr = next.find(record.Id);
+            if (record.Type == EventType::DEPARTURE)
+                completion[first + i - 1] = itr == next.end() || itr->second.Type != EventType::DEPARTURE ||
+                                            itr->second.Station != record.Station;
+            next[record.Id] = record;
+        }
+        end = first;
+    }
+
+    // forward pass, the same bookkeeping BaseStation::Process does on every event it receives
+    std::unordered_map<int, double> oldClock{};
+    for (size_t first = 0; first < count;)
+    {
+        size_t read = reader.Read(first, chunk.data(), CHUNK);
+        if (read == 0)
+            break;
+        for (size_t i = 0; i < read; i++)
+        {
+            auto &record = chunk[i];
+            // events routed to an index without a station were dropped by the scheduler
+            auto itr = stats.find(record.Station);
+            if (itr == stats.end())
+                continue;
+            auto &station = itr->second;
+            double interval = record.Clock - oldClock[record.Station];
+            oldClock[record.Station] = record.Clock;
+            if (station.sysClients > 0)
+            {
+                station.busyTime += interval;
+                station.areaN += station.sysClients * interval;
+            }
+            station.observation += interval;
+            if (record.Type == EventType::ARRIVAL)
+            {
+                station.arrivals++;
+                station.sysClients++;
+                if (station.sysClients > station.maxClients)
+                    station.maxClients = station.sysClients;
+            }
+            else if (record.Type == EventType::DEPARTURE && completion[first + i])
+            {
+                station.sysClients--;
+                station.completions++;
+            }
+        }
+        first += read;
+    }
+    return stats;
+}
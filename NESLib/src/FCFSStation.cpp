@@ -21,17 +21,17 @@ void FCFSStation::ProcessArrival(Event &evt)
     else
     {
         _eventList.Enqueue(evt);
-        core_assert((_eventList.Count() + 1) == _sysClients, "Size miss on sysclients {} and eventlist count {}",
-                    _sysClients, _eventList.Count());
+        core_assert((_eventList.Count() + 1) == sysClients(), "Size miss on sysclients {} and eventlist count {}",
+                    sysClients(), _eventList.Count());
     }
 }
 
 void FCFSStation::ProcessDeparture(Event &evt)
 {
-    core_assert(evt == _eventUnderProcess.value(), "event {} is not equal to event under process {}", evt.Name,
-                _eventUnderProcess->Name);
+    core_assert(evt == _eventUnderProcess.value(), "event {} is not equal to event under process {}", evt.Name(),
+                _eventUnderProcess->Name());
     Station::ProcessDeparture(_eventUnderProcess.value());
-    if (_sysClients > 0)
+    if (sysClients() > 0)
     {
         _eventUnderProcess.emplace(_eventList.Dequeue());
         _eventUnderProcess->ArrivalTime = _clock;
@@ -55,12 +55,12 @@ void FCFSStation::ProcessProbe(Event &evt)
     Station::ProcessProbe(evt);
 }
 
-void FCFSStation::Reset()
+void FCFSStation::ResetState()
 {
-    Station::Reset();
+    Station::ResetState();
 }
 
 FCFSStation::FCFSStation(IScheduler *scheduler, std::string name, int stationIndex)
-    : Station(name, stationIndex), _scheduler(scheduler)
+    : Station(name, stationIndex), IQueueHolder(scheduler), _scheduler(scheduler)
 {
 }
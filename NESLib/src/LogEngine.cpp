@@ -1,16 +1,12 @@
 #include "LogEngine.hpp"
 #include <cstdio>
-#include <filesystem>
+#include <cstdlib>
 #include <fmt/args.h>
 #include <fmt/color.h>
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <fstream>
-#include <ios>
-#include <istream>
-#include <ostream>
-#include <streambuf>
 #include <string>
+#include <thread>
 
 LogEngine *LogEngine::_instance = nullptr;
 
@@ -33,42 +29,98 @@ constexpr fmt::color LogTypeToColor(LogType type)
     return fmt::color::white;
 }
 
-void writeBuffer(std::istream &buffer, std::ostream &save)
+void LogEngine::WriterLoop()
 {
-    using namespace std;
-    std::string line;
-    while (std::getline(buffer, line))
+    std::FILE *logFile = _logFile.empty() ? nullptr : std::fopen(_logFile.c_str(), "a");
+    Record record{};
+    size_t reportedDrops = 0;
+    while (true)
     {
-        auto formatted = fmt::format("{}\n", line);
-        save.write(formatted.c_str(), formatted.size());
+        size_t published = _published.load(std::memory_order_acquire);
+        bool wrote = false;
+        while (_records.TryPop(record))
+        {
+            auto line = fmt::format("[{}]{}\n", record.type, record.message);
+            if (logFile != nullptr)
+                std::fwrite(line.data(), 1, line.size(), logFile);
+            if (record.print)
+                fmt::print(fmt::fg(LogTypeToColor(record.type)), "{}", line);
+            wrote = true;
+        }
+        size_t dropped = _dropped.load();
+        if (dropped != reportedDrops && logFile != nullptr)
+        {
+            fmt::print(logFile, "[{}](LogEngine){} records dropped, buffer full\n", LogType::EXCEPTION,
+                       dropped - reportedDrops);
+            reportedDrops = dropped;
+        }
+        if (wrote && logFile != nullptr)
+            std::fflush(logFile);
+        _written.store(_records.Popped(), std::memory_order_release);
+        _written.notify_all();
+        if (!_running.load() && _records.Popped() == _records.Pushed())
+            break;
+        // a producer that claimed a slot but did not fill it yet bumps _published when done
+        if (!wrote)
+            _published.wait(published, std::memory_order_acquire);
     }
+    if (logFile != nullptr)
+        std::fclose(logFile);
 }
 
 /**
- * @brief  Save the log file
- * @note   used RTTI on fstream  to save the log file so at the end of the function the stream will be closed
+ * @brief  Wait for the writer thread to save the records traced so far
+ * @note   records traced by other threads while waiting may or may not be included
  * @retval None
  */
 void LogEngine::Flush()
 {
-    using namespace std;
-    fstream logFile(_logFile, ios_base::app);
-    writeBuffer(_buffer, logFile);
-    _buffer.clear();
-    _buffer.seekp(0);
+    size_t target = _records.Pushed();
+    size_t written = _written.load(std::memory_order_acquire);
+    while (written < target)
+    {
+        _written.wait(written, std::memory_order_acquire);
+        written = _written.load(std::memory_order_acquire);
+    }
 }
 
 void LogEngine::Trace(LogType type, std::string message)
 {
-    using namespace std;
-    std::string log = fmt::format("[{}]{}\n", type, message);
-    char buffer[log.size() + 1];
-    sprintf(buffer, "%s\n", log.c_str());
-    if ((_printStdout && !_pauseStdout))
-        fmt::print(fmt::fg(LogTypeToColor(type)), "[{}]{}\n",type,message);
-    _buffer.write(buffer, log.size() + 1);
-    if (_buffer.tellp() > 1024 * 1024)
+    Record record{type, std::move(message), _printStdout && !_pauseStdout};
+    while (!_records.TryPush(std::move(record)))
     {
-        Flush();
+        if (_overflow == LogOverflow::DROP && type != LogType::EXCEPTION && type != LogType::RESULT)
+        {
+            _dropped++;
+            return;
+        }
+        std::this_thread::yield();
     }
+    _published.fetch_add(1, std::memory_order_release);
+    _published.notify_one();
+}
+
+void LogEngine::CreateInstance(std::string logFile, LogOverflow overflow, size_t capacity)
+{
+    static bool registered = false;
+    DestroyInstance();
+    _instance = new LogEngine(logFile, overflow, capacity);
+    // also covers the programs that leave through exit()
+    if (!registered)
+        registered = std::atexit(DestroyInstance) == 0;
+}
+
+void LogEngine::DestroyInstance()
+{
+    auto instance = _instance;
+    _instance = nullptr;
+    delete instance;
+}
+
+LogEngine::~LogEngine()
+{
+    _running = false;
+    _published.fetch_add(1, std::memory_order_release);
+    _published.notify_one();
+    _writer.join();
 }
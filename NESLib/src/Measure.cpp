@@ -5,8 +5,13 @@
 #include "Measure.hpp"
 #include "Core.hpp"
 #include "rvms.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <numeric>
+#include <string>
+#include <string_view>
 #include <vector>
 
 std::vector<double> slice(std::vector<double>::iterator begin, std::vector<double>::iterator end)
@@ -25,49 +30,412 @@ void CovariatedMeasure::Accumulate(double value, double time)
     _count++;
     _current[0] = value;
     _current[1] = time;
-    _sum[0] += value;
-    _sum[1] += value * value;
-    _times[0] += time;
-    _times[1] += time * time;
-    _weightedsum += (value * time);
+    double valueDelta = value - _mean[0];
+    double timeDelta = time - _mean[1];
+    _mean[0] += valueDelta / _count;
+    _mean[1] += timeDelta / _count;
+    _valueComoment += valueDelta * (value - _mean[0]);
+    _timeComoment += timeDelta * (time - _mean[1]);
+    _crossComoment += valueDelta * (time - _mean[1]);
+}
+
+void CovariatedMeasure::Merge(const CovariatedMeasure &other)
+{
+    if (other._count == 0)
+        return;
+    double count = _count + other._count;
+    double weight = _count * (double)other._count / count;
+    double valueDelta = other._mean[0] - _mean[0];
+    double timeDelta = other._mean[1] - _mean[1];
+    _valueComoment += other._valueComoment + valueDelta * valueDelta * weight;
+    _timeComoment += other._timeComoment + timeDelta * timeDelta * weight;
+    _crossComoment += other._crossComoment + valueDelta * timeDelta * weight;
+    _mean[0] += valueDelta * other._count / count;
+    _mean[1] += timeDelta * other._count / count;
+    _count += other._count;
+    _current[0] = other._current[0];
+    _current[1] = other._current[1];
+}
+
+void CovariatedMeasure::Serialize(std::string &out) const
+{
+    helper::write_state(out, _count);
+    helper::write_state(out, _current);
+    helper::write_state(out, _mean);
+    helper::write_state(out, _valueComoment);
+    helper::write_state(out, _timeComoment);
+    helper::write_state(out, _crossComoment);
+}
+
+bool CovariatedMeasure::Deserialize(std::string_view &in)
+{
+    return helper::read_state(in, _count) && helper::read_state(in, _current) && helper::read_state(in, _mean) &&
+           helper::read_state(in, _valueComoment) && helper::read_state(in, _timeComoment) &&
+           helper::read_state(in, _crossComoment);
 }
 
 double CovariatedMeasure::R() const
 {
-    return _sum[0] / _times[0];
+    // no sample, no ratio: a 0 would pass for an estimate in the quotients built on it
+    if (_count == 0)
+        return NAN;
+    return _mean[0] / _mean[1];
+}
+
+double CovariatedMeasure::residuals() const
+{
+    double r = R();
+    return _valueComoment - 2 * r * _crossComoment + r * r * _timeComoment;
 }
 
 double CovariatedMeasure::variance() const
 {
+    return residuals() * (1.0 / (_count - 1));
+}
 
-    auto a = _sum[1] - 2 * R() * _weightedsum + pow(R(), 2) * _times[1];
-    return a * (1.0 / (_count - 1));
+double CovariatedMeasure::quantile() const
+{
+    if (_quantileConfidence != _confidence)
+    {
+        double alpha = 1 - _confidence;
+        _quantile = idfNormal(0, 1, 1 - (alpha / 2));
+        _quantileConfidence = _confidence;
+    }
+    return _quantile;
 }
 
 Interval CovariatedMeasure::confidence() const
 {
-    double alpha = 1 - _confidence;
-    double r = _sum[0] / _times[0];
     double a = sqrt(((double)_count / (_count - 1.0)));
-    double b = (sqrt(_sum[1] - (2 * R() * _weightedsum) + (pow(R(), 2) * _times[1])));
-    double delta = a * (b / _times[0]);
-    double t = idfNormal(0, 1, 1 - (alpha / 2));
-    return Interval(R(), delta * t);
+    double b = sqrt(residuals());
+    double delta = a * (b / (_mean[1] * _count));
+    return Interval(R(), delta * quantile());
+}
+
+int CovariatedMeasure::SampleNeedsForPrecision() const
+{
+    return SampleNeedsForPrecision(_precision);
+}
+
+int CovariatedMeasure::SampleNeedsForPrecision(double precision) const
+{
+    // the half width is quantile * s / (mean time * sqrt(n)), solved for n at half width R * precision
+    double a = quantile() * sqrt(variance());
+    double b = _mean[1] * R() * precision;
+    double needs = ceil(pow(a / b, 2));
+    if (_count < 2 || !(needs < std::numeric_limits<int>::max()))
+        return std::numeric_limits<int>::max();
+    return needs;
+}
+
+QuantileMeasure::QuantileMeasure(std::string name, std::string unit, double accuracy, size_t maxBins)
+    : Measure<double>(name, unit), _accuracy(accuracy), _logGamma(std::log((1 + accuracy) / (1 - accuracy))),
+      _maxBins(maxBins)
+{
+}
+
+size_t QuantileMeasure::Index(int key)
+{
+    if (_bins.empty())
+    {
+        _offset = key;
+        _bins.push_back(0);
+        return 0;
+    }
+    int last = _offset + (int)_bins.size() - 1;
+    if (key >= _offset && key <= last)
+        return key - _offset;
+    int low = std::min(key, _offset);
+    int high = std::max(key, last);
+    if ((size_t)(high - low + 1) > _maxBins)
+        low = high - (int)_maxBins + 1;
+    std::vector<uint64_t> bins(high - low + 1);
+    for (size_t i = 0; i < _bins.size(); i++)
+        bins[std::max(_offset + (int)i, low) - low] += _bins[i];
+    _bins = std::move(bins);
+    _offset = low;
+    return std::max(key, low) - low;
+}
+
+void QuantileMeasure::Accumulate(double value)
+{
+    Measure<double>::Accumulate(value);
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    if (value < MIN_VALUE)
+        _zeros++;
+    else
+        _bins[Index(Key(value))]++;
+}
+
+double QuantileMeasure::Quantile(double q) const
+{
+    if (_count == 0)
+        return NAN;
+    double rank = q * (_count - 1);
+    if (rank < _zeros)
+        return std::max(_min, 0.0);
+    double counted = _zeros;
+    double gamma = std::exp(_logGamma);
+    for (size_t i = 0; i < _bins.size(); i++)
+    {
+        counted += _bins[i];
+        if (counted > rank)
+        {
+            double value = 2 * std::pow(gamma, _offset + (int)i) / (gamma + 1);
+            return std::clamp(value, _min, _max);
+        }
+    }
+    return _max;
+}
+
+void QuantileMeasure::Merge(const QuantileMeasure &other)
+{
+    if (other._count == 0)
+        return;
+    if (other._logGamma != _logGamma)
+        panic("Quantile measures with different accuracy cannot be merged");
+    for (size_t i = 0; i < other._bins.size(); i++)
+    {
+        if (other._bins[i] > 0)
+            _bins[Index(other._offset + (int)i)] += other._bins[i];
+    }
+    _zeros += other._zeros;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _count += other._count;
+}
+
+void QuantileMeasure::Serialize(std::string &out) const
+{
+    helper::write_state(out, _count);
+    helper::write_state(out, _accuracy);
+    helper::write_state(out, _zeros);
+    helper::write_state(out, _min);
+    helper::write_state(out, _max);
+    helper::write_state(out, _offset);
+    helper::write_state(out, (uint32_t)_bins.size());
+    out.append(reinterpret_cast<const char *>(_bins.data()), _bins.size() * sizeof(uint64_t));
+}
+
+bool QuantileMeasure::Deserialize(std::string_view &in)
+{
+    uint32_t bins = 0;
+    bool valid = helper::read_state(in, _count) && helper::read_state(in, _accuracy) &&
+                 helper::read_state(in, _zeros) && helper::read_state(in, _min) && helper::read_state(in, _max) &&
+                 helper::read_state(in, _offset) && helper::read_state(in, bins);
+    _logGamma = std::log((1 + _accuracy) / (1 - _accuracy));
+    _bins.resize(valid ? bins : 0);
+    for (size_t i = 0; valid && i < _bins.size(); i++)
+        valid = helper::read_state(in, _bins[i]);
+    return valid;
+}
+
+std::string QuantileMeasure::Heading()
+{
+    auto name = Name();
+    return fmt::format("{};p50Of{};p95Of{};p99Of{}", Measure<double>::Heading(), name, name, name);
+}
+
+std::string QuantileMeasure::Csv()
+{
+    return fmt::format("{};{};{};{}", Measure<double>::Csv(), Quantile(0.5), Quantile(0.95), Quantile(0.99));
+}
+
+std::string QuantileMeasure::Json()
+{
+    return fmt::format("{},\n \"samples\":{},\n \"p50\":{},\n \"p95\":{},\n \"p99\":{},\n \"min\":{},\n "
+                       "\"max\":{}\n",
+                       Measure<double>::Json(), Count(), Quantile(0.5), Quantile(0.95), Quantile(0.99), _min, _max);
+}
+
+void QuantileMeasure::Reset()
+{
+    Measure<double>::Reset();
+    _bins.clear();
+    _zeros = 0;
+    _min = std::numeric_limits<double>::infinity();
+    _max = -std::numeric_limits<double>::infinity();
+}
+
+BatchMeansMeasure::BatchMeansMeasure(std::string name, std::string unit, size_t slots, double threshold)
+    : Measure<double>(name, unit), _slots(std::max(slots, 2 * MIN_BATCHES)), _threshold(threshold)
+{
+    _means.reserve(_slots);
+}
+
+void BatchMeansMeasure::Compact()
+{
+    for (size_t i = 0; i + 1 < _means.size(); i += 2)
+        _means[i / 2] = (_means[i] + _means[i + 1]) / 2;
+    _means.resize(_means.size() / 2);
+    _batchSize *= 2;
+}
+
+void BatchMeansMeasure::Accumulate(double value)
+{
+    if (_discarded < _warmup)
+    {
+        _discarded++;
+        return;
+    }
+    Measure<double>::Accumulate(value);
+    _batchSum += value;
+    if (++_batchCount < _batchSize)
+        return;
+    _means.push_back(_batchSum / _batchSize);
+    _batchSum = 0.0;
+    _batchCount = 0;
+    if (_means.size() == _slots)
+        Compact();
+}
+
+std::vector<double> BatchMeansMeasure::Grouped(size_t group) const
+{
+    std::vector<double> grouped(_means.size() / group);
+    for (size_t i = 0; i < grouped.size(); i++)
+        grouped[i] = std::accumulate(_means.begin() + i * group, _means.begin() + (i + 1) * group, 0.0) / group;
+    return grouped;
+}
+
+static double LagCorrelation(const std::vector<double> &values, size_t lag)
+{
+    if (values.size() <= lag + 1)
+        return NAN;
+    double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    double variance = 0.0;
+    double covariance = 0.0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        variance += (values[i] - mean) * (values[i] - mean);
+        if (i + lag < values.size())
+            covariance += (values[i] - mean) * (values[i + lag] - mean);
+    }
+    return variance > 0 ? covariance / variance : 0.0;
+}
+
+double BatchMeansMeasure::Autocorrelation(size_t lag, size_t group) const
+{
+    return LagCorrelation(Grouped(group), lag);
+}
+
+size_t BatchMeansMeasure::SelectedGroup() const
+{
+    for (size_t group = 1; _means.size() / group >= MIN_BATCHES; group *= 2)
+    {
+        if (std::abs(Autocorrelation(1, group)) <= _threshold)
+            return group;
+    }
+    return 0;
 }
 
-int CovariatedMeasure::SampleNeedsForPrecision()
+double BatchMeansMeasure::mean() const
 {
-    auto alpha = 1 - _confidence;
-    auto t = idfNormal(0, 1, 1 - (alpha / 2));
-    auto a = t * variance();
-    auto b = R() * _precision;
-    return floor(pow(a / b, 2));
+    if (_means.empty())
+        return NAN;
+    return std::accumulate(_means.begin(), _means.end(), 0.0) / _means.size();
+}
+
+Interval BatchMeansMeasure::confidence() const
+{
+    size_t group = SelectedGroup();
+    if (group == 0)
+        return {mean(), INFINITY};
+    auto grouped = Grouped(group);
+    size_t batches = grouped.size();
+    double u = std::accumulate(grouped.begin(), grouped.end(), 0.0) / batches;
+    double variance = 0.0;
+    for (double m : grouped)
+        variance += (m - u) * (m - u);
+    variance /= batches - 1;
+    double alpha = 1 - _confidence;
+    return {mean(), idfStudent(batches - 1, 1 - alpha / 2) * std::sqrt(variance / batches)};
+}
+
+void BatchMeansMeasure::Merge(const BatchMeansMeasure &other)
+{
+    auto means = other._means;
+    for (size_t size = other._batchSize; size < _batchSize; size *= 2)
+    {
+        for (size_t i = 0; i + 1 < means.size(); i += 2)
+            means[i / 2] = (means[i] + means[i + 1]) / 2;
+        means.resize(means.size() / 2);
+    }
+    while (_batchSize < other._batchSize)
+        Compact();
+    for (double m : means)
+    {
+        _means.push_back(m);
+        if (_means.size() == _slots)
+            Compact();
+    }
+    // the partial batch of other and the batches dropped to reach the common size are not in the means
+    _count = _means.size() * _batchSize + _batchCount;
+}
+
+void BatchMeansMeasure::Serialize(std::string &out) const
+{
+    helper::write_state(out, _count);
+    helper::write_state(out, _warmup);
+    helper::write_state(out, _discarded);
+    helper::write_state(out, _batchSize);
+    helper::write_state(out, _batchSum);
+    helper::write_state(out, _batchCount);
+    helper::write_state(out, (uint32_t)_means.size());
+    for (double m : _means)
+        helper::write_state(out, m);
+}
+
+bool BatchMeansMeasure::Deserialize(std::string_view &in)
+{
+    uint32_t means = 0;
+    bool valid = helper::read_state(in, _count) && helper::read_state(in, _warmup) &&
+                 helper::read_state(in, _discarded) && helper::read_state(in, _batchSize) &&
+                 helper::read_state(in, _batchSum) && helper::read_state(in, _batchCount) &&
+                 helper::read_state(in, means) && means < _slots;
+    _means.resize(valid ? means : 0);
+    for (size_t i = 0; valid && i < _means.size(); i++)
+        valid = helper::read_state(in, _means[i]);
+    return valid;
+}
+
+std::string BatchMeansMeasure::Heading()
+{
+    auto name = Name();
+    return fmt::format("{};meanOf{};batchSizeOf{};lowerBoundOf{};upperBoundOf{}", Measure<double>::Heading(), name,
+                       name, name, name);
+}
+
+std::string BatchMeansMeasure::Csv()
+{
+    auto interval = confidence();
+    return fmt::format("{};{};{};{};{}", Measure<double>::Csv(), mean(), BatchSize(), interval.lower(),
+                       interval.higher());
+}
+
+std::string BatchMeansMeasure::Json()
+{
+    auto interval = confidence();
+    return fmt::format("{},\n \"samples\":{},\n \"mean\":{},\n \"batch_size\":{},\n \"lag1\":{},\n "
+                       "\"lower_bound\":{},\n \"higher_bound\":{},\n \"precision\":{}\n",
+                       Measure<double>::Json(), Count(), mean(), BatchSize(), Autocorrelation(1), interval.lower(),
+                       interval.higher(), interval.precision());
+}
+
+void BatchMeansMeasure::Reset()
+{
+    Measure<double>::Reset();
+    _discarded = 0;
+    _batchSize = 1;
+    _batchSum = 0.0;
+    _batchCount = 0;
+    _means.clear();
 }
 
 void MobileMeanMeasure::push(double value)
 {
     _buffer[_bufferPtr] = value;
-    if (_bufferPtr == _buffer.size() - 1)
+    if (_bufferPtr == (int)_buffer.size() - 1)
     {
         double mean = 0;
         // calculate mean in _buffer
@@ -90,8 +458,10 @@ void MobileMeanMeasure::push(double value)
 
 double MobileMeanMeasure::delta() const
 {
-    double u1 = _means[(_meansPtr - 2) % _means.size()];
-    double u2 = _means[(_meansPtr - 1) % _means.size()];
+    // _meansPtr is the next slot to write, the two last means are behind it
+    int size = _means.size();
+    double u1 = _means[(_meansPtr + size - 2) % size];
+    double u2 = _means[(_meansPtr + size - 1) % size];
     if (u1 == 0 && u2 == 0)
     {
         return HUGE_VAL;
@@ -100,6 +470,93 @@ double MobileMeanMeasure::delta() const
 }
 
 MobileMeanMeasure::MobileMeanMeasure(int bufferSize, int maxMeans)
-    : _means(bufferSize), _buffer(maxMeans), _bufferPtr(), _meansPtr(), BaseMeasure("mobilemean", "s")
+    : BaseMeasure("mobilemean", "s"), _means(maxMeans), _buffer(bufferSize), _meansPtr(), _bufferPtr()
+{
+}
+
+WarmupDetector::WarmupDetector(size_t batchSize, size_t minBatches, size_t maxBatches)
+    : _initialBatchSize(batchSize), _batchSize(batchSize), _minBatches(minBatches),
+      _maxBatches(std::max(maxBatches, 2 * minBatches)), _nextCheck(minBatches)
+{
+}
+
+void WarmupDetector::Push(double value)
+{
+    _observations++;
+    _batchSum += value;
+    if (++_batchCount < _batchSize)
+        return;
+    double mean = _batchSum / _batchSize;
+    _batchSum = 0.0;
+    _batchCount = 0;
+    if (_means.empty())
+        _shift = mean;
+    _means.push_back(mean);
+    double shifted = mean - _shift;
+    _prefix.push_back(_prefix.back() + shifted);
+    _prefixSquares.push_back(_prefixSquares.back() + shifted * shifted);
+    if (_means.size() == _maxBatches)
+        Compact();
+    if (!_ended && _means.size() >= _nextCheck)
+    {
+        Evaluate();
+        _nextCheck = _means.size() + std::max<size_t>(1, _means.size() / 4);
+    }
+}
+
+void WarmupDetector::Compact()
+{
+    for (size_t i = 0; i + 1 < _means.size(); i += 2)
+        _means[i / 2] = (_means[i] + _means[i + 1]) / 2;
+    _means.resize(_means.size() / 2);
+    _batchSize *= 2;
+    _prefix.assign(1, 0.0);
+    _prefixSquares.assign(1, 0.0);
+    for (double mean : _means)
+    {
+        _prefix.push_back(_prefix.back() + (mean - _shift));
+        _prefixSquares.push_back(_prefixSquares.back() + (mean - _shift) * (mean - _shift));
+    }
+    _nextCheck = _means.size();
+}
+
+void WarmupDetector::Evaluate()
+{
+    size_t n = _means.size();
+    if (n < _minBatches)
+        return;
+    size_t best = 0;
+    double bestStatistic = INFINITY;
+    for (size_t d = 0; d <= n / 2; d++)
+    {
+        double k = n - d;
+        double sum = _prefix[n] - _prefix[d];
+        double squares = _prefixSquares[n] - _prefixSquares[d];
+        double statistic = std::max(squares - sum * sum / k, 0.0) / (k * k);
+        if (statistic < bestStatistic)
+        {
+            bestStatistic = statistic;
+            best = d;
+        }
+    }
+    // a minimum at the last candidate means the sequence is still drifting
+    if (best < n / 2)
+    {
+        _ended = true;
+        _truncation = best * _batchSize;
+    }
+}
+
+void WarmupDetector::Reset()
 {
+    _batchSize = _initialBatchSize;
+    _observations = 0;
+    _batchSum = 0.0;
+    _batchCount = 0;
+    _means.clear();
+    _prefix.assign(1, 0.0);
+    _prefixSquares.assign(1, 0.0);
+    _nextCheck = _minBatches;
+    _ended = false;
+    _truncation = 0;
 }
@@ -9,7 +9,7 @@ void RegenerationPoint::Trigger()
     _called++;
     if (_rulesEnabled)
     {
-        for (auto r : _rules)
+        for (auto &r : _rules)
         {
             if (!r(this))
             {
@@ -17,7 +17,7 @@ void RegenerationPoint::Trigger()
             }
         }
     }
-    for (auto a : _actions)
+    for (auto &a : _actions)
     {
         a(this);
     }
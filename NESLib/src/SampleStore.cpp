@@ -0,0 +1,166 @@
+#include "Collections/SampleStore.hpp"
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedSamples::MappedSamples(const std::string &path)
+{
+#ifdef _WIN32
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        _file = nullptr;
+        return;
+    }
+    LARGE_INTEGER length{};
+    if (!GetFileSizeEx(_file, &length) || length.QuadPart < (LONGLONG)sizeof(double))
+    {
+        Release();
+        return;
+    }
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr)
+    {
+        Release();
+        return;
+    }
+    _data = static_cast<const double *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        Release();
+        return;
+    }
+    _size = length.QuadPart / sizeof(double);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(double))
+    {
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            _data = static_cast<const double *>(data);
+            _size = info.st_size / sizeof(double);
+        }
+    }
+    // the mapping keeps its own reference to the file
+    close(fd);
+#endif
+}
+
+void MappedSamples::Release()
+{
+#ifdef _WIN32
+    if (_data != nullptr)
+        UnmapViewOfFile(_data);
+    if (_mapping != nullptr)
+        CloseHandle(_mapping);
+    if (_file != nullptr)
+        CloseHandle(_file);
+    _mapping = nullptr;
+    _file = nullptr;
+#else
+    if (_data != nullptr)
+        munmap(const_cast<double *>(_data), _size * sizeof(double));
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+MappedSamples::MappedSamples(MappedSamples &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedSamples &MappedSamples::operator=(MappedSamples &&other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+#ifdef _WIN32
+        std::swap(_file, other._file);
+        std::swap(_mapping, other._mapping);
+#endif
+    }
+    return *this;
+}
+
+MappedSamples::~MappedSamples()
+{
+    Release();
+}
+
+SampleStore::SampleStore(size_t windowSize, std::string path) : _windowSize(windowSize), _path(std::move(path))
+{
+    if (_windowSize == 0)
+        _windowSize = 1;
+    _spillAt = _windowSize;
+    if (!_path.empty())
+        _file = std::fopen(_path.c_str(), "wb");
+    // the window is the buffer, fwrite then reports the samples that really reached the file
+    if (_file != nullptr)
+        std::setvbuf(_file, nullptr, _IONBF, 0);
+    _window.reserve(_file != nullptr ? _windowSize : 0);
+}
+
+SampleStore::~SampleStore()
+{
+    if (_file != nullptr)
+    {
+        Flush();
+        std::fclose(_file);
+    }
+}
+
+void SampleStore::Spill()
+{
+    size_t written = std::fwrite(_window.data(), sizeof(double), _window.size(), _file);
+    _spilled += written;
+    _window.erase(_window.begin(), _window.begin() + written);
+    if (!_window.empty())
+        std::clearerr(_file);
+    _spillAt = _window.size() + _windowSize;
+}
+
+void SampleStore::Flush()
+{
+    if (_file == nullptr)
+        return;
+    if (!_window.empty())
+        Spill();
+    std::fflush(_file);
+}
+
+void SampleStore::Clear()
+{
+    _window.clear();
+    _spilled = 0;
+    _spillAt = _windowSize;
+    if (_file != nullptr)
+        _file = std::freopen(_path.c_str(), "wb", _file);
+    if (_file != nullptr)
+        std::setvbuf(_file, nullptr, _IONBF, 0);
+}
+
+MappedSamples SampleStore::Map()
+{
+    if (_file == nullptr)
+        return {};
+    Flush();
+    if (!_window.empty())
+        return {};
+    return MappedSamples{_path};
+}
@@ -5,26 +5,72 @@
 #include "Station.hpp"
 #include <fmt/core.h>
 
-bool Scheduler::Route(Event evt)
+bool Scheduler::Route(const Event &evt)
 {
-    for (auto station : _stations)
+    if (evt.Station < 0 || evt.Station >= (int)_routes.size() || _routes[evt.Station] == nullptr)
+        return false;
+    // stations work on their own copy, the caller keeps the event as it was dequeued
+    Event routed = evt;
+    _routes[evt.Station]->Process(routed);
+    return true;
+}
+
+void Scheduler::Register(sptr<Station> station)
+{
+    station->Attach(_stationTable);
+    _stations.push_back(station);
+    // the records of the table may have moved when it grew
+    for (auto &s : _stations)
+        s->Rebind();
+    int index = station->stationIndex();
+    // like the old linear lookup, the first station added wins on a duplicated index or name
+    if (index >= 0)
     {
-        if (evt.Station == station->stationIndex())
-        {
-            station->Process(evt);
-            return true;
-        }
+        if (index >= (int)_routes.size())
+            _routes.resize(index + 1);
+        if (_routes[index] == nullptr)
+            _routes[index] = station;
     }
-    return false;
+    _names.emplace(station->Name(), station);
 }
-void Scheduler::Schedule(Event event)
+void Scheduler::Schedule(const Event &event)
 {
     if (event.OccurTime < _clock)
     {
         panic(fmt::format("Scheduling of event {} break the rules since clock is {}", event, _clock));
     }
     _logger.Transfer("Scheduling:{}", event);
-    _eventList.Insert(event, [](const Event &a, const Event &b) { return a.OccurTime > b.OccurTime; });
+    _eventList->Insert(event);
+}
+
+void Scheduler::UseEventQueue(EventQueueType queueType)
+{
+    if (_eventList->Type() == queueType)
+        return;
+    auto queue = EventQueue::Create(queueType);
+    for (auto &evt : _eventList->Ordered())
+        queue->Insert(evt);
+    _eventList = std::move(queue);
+}
+
+bool Scheduler::RecordTrace(std::string file)
+{
+    TraceStations stations{};
+    for (auto &s : _stations)
+        stations.emplace_back(s->stationIndex(), s->Name());
+    _trace = std::make_unique<TraceWriter>(file, stations);
+    if (!_trace->IsOpen())
+    {
+        _logger.Exception("Cannot open trace file {}", file);
+        _trace.reset();
+        return false;
+    }
+    return true;
+}
+
+void Scheduler::StopTrace()
+{
+    _trace.reset();
 }
 
 void Scheduler::Initialize()
@@ -33,7 +79,8 @@ void Scheduler::Initialize()
 
 Event Scheduler::ProcessNext()
 {
-    auto evt = _eventList.Dequeue();
+    auto evt = _eventList->Dequeue();
+    RecordEvent(evt);
     Process(evt);
     Route(evt);
     return evt;
@@ -41,12 +88,14 @@ Event Scheduler::ProcessNext()
 
 Event Scheduler::Create(double interArrival, double serviceTime, int stationTarget, EventType type)
 {
-    std::string name = fmt::format("J{}", Event::GeneratedNodes);
-    return Event{name, type, _clock, _clock + interArrival, serviceTime, _clock + interArrival, stationTarget};
+    return Event{NewCustomerId(), type, _clock, _clock + interArrival, serviceTime, _clock + interArrival, stationTarget};
 }
 
 void Scheduler::Reset()
 {
+    // a new observation period at the clock of the scheduler, one pass over the table resets every counter
+    Sync();
+    _stationTable->Reset(_clock);
     for (auto &s : _stations)
-        s->Reset();
+        s->ResetState();
 }
\ No newline at end of file
@@ -166,6 +166,7 @@ ShellCommand(ne)
 
 ShellCommand(help)
 {
+    LogLocker lock{};
     fmt::print("List of available commands:");
     for (auto c : shell->Cmds())
     {
@@ -190,4 +191,20 @@ ShellCommand(seed)
         RandomStream::Global().SetAntitetich(false);
         RandomStream::Global().PlantSeeds(seed);
     }
-};
\ No newline at end of file
+};
+ShellCommand(rng)
+{
+    std::string engine{};
+    std::istringstream stream{context};
+    stream >> engine;
+    if (engine == "lehmer")
+        RandomStream::Global().UseEngine(RandomEngine::LEHMER);
+    else if (engine == "xoshiro")
+        RandomStream::Global().UseEngine(RandomEngine::XOSHIRO256PP);
+    else
+    {
+        shell->Log()->Exception("Usage: rng lehmer|xoshiro");
+        return;
+    }
+    shell->Log()->Information("Using {} streams planted from the default seed", engine);
+};
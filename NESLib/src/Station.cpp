@@ -35,17 +35,26 @@ enum Measures
 
 void BaseStation::ProcessArrival(Event &evt)
 {
-    _arrivals++;
-    _sysClients++;
-    _lastArrival = evt.OccurTime;
-    if (_sysClients > _maxClients)
-        _maxClients = _sysClients;
+    auto &counters = Counters();
+    counters.arrivals++;
+    counters.population.Change(+1, _clock, _histogram);
+    evt.StationArrival = _clock;
+    counters.lastArrival = evt.OccurTime;
+    if (counters.population.Count() > counters.maxClients)
+        counters.maxClients = counters.population.Count();
 }
 
 void BaseStation::ProcessDeparture(Event &evt)
 {
-    _sysClients--;
-    _completions++;
+    auto &counters = Counters();
+    counters.population.Change(-1, _clock, _histogram);
+    counters.completions++;
+    _lastResponse = NAN;
+    if (_responseTimes.has_value())
+    {
+        _lastResponse = _clock - evt.StationArrival;
+        _responseTimes->Accumulate(_lastResponse);
+    }
 }
 
 void BaseStation::ProcessEnd(Event &evt)
@@ -54,14 +63,23 @@ void BaseStation::ProcessEnd(Event &evt)
 
 void BaseStation::Reset()
 {
-    _arrivals = 0;
-    _completions = 0;
-    _maxClients = 0;
-    _busyTime = 0.0;
-    _observationPeriod = 0.0;
-    _lastArrival = 0.0;
-    _areaN = 0.0;
-    _areaS = 0.0;
+    Counters().Reset(clock());
+    ResetState();
+}
+
+void BaseStation::ResetState()
+{
+    _histogram.assign(_histogram.size(), 0.0);
+    if (_responseTimes.has_value())
+        _responseTimes->Reset();
+}
+
+void BaseStation::Attach(std::shared_ptr<StationTable> table)
+{
+    auto counters = Counters();
+    _table = std::move(table);
+    _slot = _table->Add(counters);
+    Rebind();
 }
 
 BaseStation::BaseStation(std::string name) : _logger(name), _name(name)
@@ -80,52 +98,12 @@ void Station::ProcessProbe(Event &evt)
 
 void BaseStation::Process(Event &event)
 {
-    core_assert(event.OccurTime >= _clock, "Event {} occur at a lesser time of {} in station {}", event, _clock, _name);
-    _clock = event.OccurTime;
-    _logger.Transfer("Processing:{}", event);
-    double interval = _clock - _oldclock;
-    _oldclock = _clock;
-    if (_sysClients > 0)
-    {
-        _busyTime += interval;
-        _areaN += _sysClients * interval;
-        _areaS += (_sysClients - 1) * interval;
-    }
-    _observationPeriod += interval;
-    switch (event.Type)
-    {
-    case EventType::ARRIVAL:
-        _logger.Transfer("Arrival:{}", event);
-        for (auto &h : _onArrival)
-            h(this, event);
-        for (auto &j : _onArrivalOnce)
-            j(this, event);
-        _onArrivalOnce.clear();
-        ProcessArrival(event);
-        break;
-    case EventType::DEPARTURE:
-        ProcessDeparture(event);
-        for (auto &h : _onDeparture)
-            h(this, event);
-        for (auto &j : _onDepartureOnce)
-            j(this, event);
-        _onDepartureOnce.clear();
-        _logger.Transfer("Departure:{}", event);
-        break;
-    case EventType::NO_EVENT:
-        break;
-    case EventType::END:
-        _logger.Transfer("End:{}", event);
-        ProcessEnd(event);
-        break;
-    case EventType::PROBE:
-        ProcessProbe(event);
-    }
+    ProcessAs(*this, event);
 }
 
-void Station::Reset()
+void Station::ResetState()
 {
-    BaseStation::Reset();
+    BaseStation::ResetState();
 }
 
 Station::Station(std::string name, int station) : BaseStation(name), _stationIndex(station)
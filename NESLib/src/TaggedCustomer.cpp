@@ -11,9 +11,9 @@
 void TaggedCustomer::ConnectEntrance(BaseStation *station, bool arrival)
 {
     auto l = [this, station](auto s, Event &e) {
-        if (target_client == "")
-            target_client = e.Name;
-        if (e.Name == target_client)
+        if (!target_client.has_value())
+            target_client = e.Id;
+        if (e.Id == target_client)
         {
             time = e.OccurTime;
             if (_onEntrance.has_value())
@@ -29,10 +29,17 @@ void TaggedCustomer::ConnectEntrance(BaseStation *station, bool arrival)
 void TaggedCustomer::ConnectLeave(BaseStation *station, bool arrival)
 {
     auto l = [this, station](auto s, Event &e) {
-        if (e.Name == target_client)
+        if (e.Id == target_client)
         {
             double interval = e.OccurTime - time;
             _acc.Accumulate(interval);
+            if (!_transitory.Transitory())
+            {
+                _batches.Accumulate(interval);
+                _quantiles.Accumulate(interval);
+            }
+            else
+                _pendingIntervals.push_back(interval);
             if (_onLeave.has_value())
                 _onLeave.value()(e);
         }
@@ -45,9 +52,17 @@ void TaggedCustomer::ConnectLeave(BaseStation *station, bool arrival)
 
 void TaggedCustomer::CompleteRegCycle(double actualclock)
 {
-    if (_transitory.delta() > 0.1)
+    if (_transitory.Transitory())
     {
-        _transitory.push(_acc.sum() / _acc.Count());
+        // cycles without a completion of the tagged customer are carried over to the next one
+        if (_acc.Count() > 0)
+        {
+            _pendingCycles.emplace_back(_acc.sum(), _acc.Count());
+            _transitory.Push(_acc.mean());
+            _acc.Reset();
+            if (!_transitory.Transitory())
+                ReplayWarmCycles();
+        }
     }
     else
     {
@@ -56,7 +71,33 @@ void TaggedCustomer::CompleteRegCycle(double actualclock)
     }
 }
 
+void TaggedCustomer::ReplayWarmCycles()
+{
+    size_t first = std::min(_transitory.TruncationPoint(), _pendingCycles.size());
+    size_t skipped = 0;
+    for (size_t i = 0; i < first; i++)
+        skipped += _pendingCycles[i].second;
+    for (size_t i = first; i < _pendingCycles.size(); i++)
+        _mean(_pendingCycles[i].first, _pendingCycles[i].second);
+    for (size_t i = skipped; i < _pendingIntervals.size(); i++)
+    {
+        _batches.Accumulate(_pendingIntervals[i]);
+        _quantiles.Accumulate(_pendingIntervals[i]);
+    }
+    _pendingCycles = {};
+    _pendingIntervals = {};
+}
+
+void TaggedCustomer::RestartWarmup()
+{
+    _transitory.Reset();
+    _pendingCycles = {};
+    _pendingIntervals = {};
+}
+
 void TaggedCustomer::CompleteSimulation()
 {
     _mean.Reset();
+    _quantiles.Reset();
+    _batches.Reset();
 }
@@ -33,11 +33,74 @@
  */
 
 #include "rngs.hpp"
+#include "Core.hpp"
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <stdio.h>
 #include <time.h>
 #include <vector>
 
+/* xoshiro256++ by David Blackman and Sebastiano Vigna, https://prng.di.unimi.it */
+static const uint64_t XOSHIRO_JUMP[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                                         0x39abdc4529b1661c}; /* 2^128 draws */
+static const uint64_t XOSHIRO_LONG_JUMP[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+                                              0x39109bb02acbe635}; /* 2^192 draws */
+
+static inline uint64_t Rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t StepXoshiro(std::array<uint64_t, 4> &s)
+{
+    uint64_t result = Rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl(s[3], 45);
+    return result;
+}
+
+static void JumpXoshiro(std::array<uint64_t, 4> &s, const uint64_t (&polynomial)[4])
+{
+    std::array<uint64_t, 4> jumped{};
+    for (uint64_t word : polynomial)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (word & (uint64_t{1} << b))
+            {
+                for (int i = 0; i < 4; i++)
+                    jumped[i] ^= s[i];
+            }
+            StepXoshiro(s);
+        }
+    }
+    s = jumped;
+}
+
+double RandomStream::NextXoshiro()
+/* ----------------------------------------------------------------
+ * Takes the upper 53 bits of the next output, centered in their
+ * interval so that, like the Lehmer generator, 0.0 and 1.0 are
+ * never returned.
+ * ----------------------------------------------------------------
+ */
+{
+    return ((StepXoshiro(xoshiro[stream]) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+void RandomStream::SplitXoshiro()
+{
+    auto next = xoshiro.back();
+    JumpXoshiro(next, XOSHIRO_JUMP);
+    xoshiro.push_back(next);
+}
+
 double RandomStream::Random(void)
 /* ----------------------------------------------------------------
  * Random returns a pseudo-random real number uniformly distributed
@@ -45,10 +108,16 @@ double RandomStream::Random(void)
  * ----------------------------------------------------------------
  */
 {
+    if (engine == RandomEngine::XOSHIRO256PP)
+    {
+        double u = NextXoshiro();
+        return antitethic ? 1 - u : u;
+    }
     const long Q = MODULUS / MULTIPLIER;
     const long R = MODULUS % MULTIPLIER;
     long t;
 
+    draws[stream]++;
     t = MULTIPLIER * (seed[stream] % Q) - R * (seed[stream] / Q);
     if (t > 0)
         seed[stream] = t;
@@ -58,6 +127,59 @@ double RandomStream::Random(void)
     return antitethic? 1-n:n;
 }
 
+void RandomStream::Fill(std::span<double> out)
+/* ----------------------------------------------------------------
+ * Fills out with the next out.size() numbers of the current stream,
+ * the same values returned by as many calls to Random(). The Lehmer
+ * states are advanced in LANES interleaved lanes, each multiplied by
+ * MULTIPLIER^LANES, so that the products are independent and the
+ * loop can be vectorized; MODULUS is a Mersenne prime, so the
+ * reduction needs only shifts and masks.
+ * ----------------------------------------------------------------
+ */
+{
+    if (engine == RandomEngine::XOSHIRO256PP)
+    {
+        for (auto &u : out)
+            u = NextXoshiro();
+    }
+    else if (!out.empty())
+    {
+        constexpr size_t LANES = 8;
+        const uint64_t m = MODULUS;
+        const uint64_t step = Jump(1, LANES);
+        draws[stream] += out.size();
+        uint64_t lane[LANES];
+        uint64_t x = seed[stream];
+        for (size_t j = 0; j < LANES; j++)
+        {
+            x = (x * MULTIPLIER) % m;
+            lane[j] = x;
+        }
+        /* the last 1..LANES numbers are taken from the lanes as they are */
+        size_t i = 0;
+        for (; i + LANES < out.size(); i += LANES)
+        {
+            for (size_t j = 0; j < LANES; j++)
+            {
+                out[i + j] = (double)lane[j] / MODULUS;
+                uint64_t p = lane[j] * step;
+                uint64_t r = (p & m) + (p >> 31);
+                lane[j] = r >= m ? r - m : r;
+            }
+        }
+        size_t j = 0;
+        for (; i < out.size(); i++, j++)
+            out[i] = (double)lane[j] / MODULUS;
+        seed[stream] = (long)lane[j - 1];
+    }
+    if (antitethic)
+    {
+        for (auto &u : out)
+            u = 1 - u;
+    }
+}
+
 void RandomStream::PlantSeeds(long x)
 /* ---------------------------------------------------------------------
  * Use this function to set the state of all the random number generator
@@ -74,6 +196,18 @@ void RandomStream::PlantSeeds(long x)
     int s;
 
     initialized = 1;
+    if (engine == RandomEngine::XOSHIRO256PP)
+    {
+        s = stream;
+        stream = 0;
+        xoshiro.assign(1, {});
+        PutSeed(x);
+        stream = s;
+        while ((int)xoshiro.size() <= stream)
+            SplitXoshiro();
+        return;
+    }
+    std::fill(std::begin(draws), std::end(draws), 0);
     s = stream;      /* remember the current stream */
     SelectStream(0); /* change to stream 0          */
     PutSeed(x);      /* set seed[0]                 */
@@ -98,22 +232,59 @@ void RandomStream::PutSeed(long x)
  * ---------------------------------------------------------------
  */
 {
-    char ok = 0;
     if (x > 0)
         x = x % MODULUS; /* correct if x is too large  */
     if (x <= 0)
         x = ((unsigned long)time((time_t *)NULL)) % MODULUS;
+    if (engine == RandomEngine::XOSHIRO256PP)
+    {
+        /* expand the seed with splitmix64, as recommended by the xoshiro authors */
+        uint64_t z = x;
+        for (auto &word : xoshiro[stream])
+        {
+            z += 0x9e3779b97f4a7c15;
+            uint64_t w = z;
+            w = (w ^ (w >> 30)) * 0xbf58476d1ce4e5b9;
+            w = (w ^ (w >> 27)) * 0x94d049bb133111eb;
+            word = w ^ (w >> 31);
+        }
+        return;
+    }
     seed[stream] = x;
 }
 
 void RandomStream::GetSeed(long *x)
 /* ---------------------------------------------------------------
  * Use this function to get the state of the current random number
- * generator stream.
+ * generator stream. A xoshiro state is 256 bits wide, the value
+ * returned is only a fingerprint of it and PutSeed does not bring
+ * the stream back: use GetState and PutState to save and restore.
  * ---------------------------------------------------------------
  */
 {
-    *x = seed[stream];
+    if (engine == RandomEngine::XOSHIRO256PP)
+        *x = (long)(xoshiro[stream][0] >> 33);
+    else
+        *x = seed[stream];
+}
+
+std::array<uint64_t, 4> RandomStream::GetState() const
+{
+    if (engine == RandomEngine::XOSHIRO256PP)
+        return xoshiro[stream];
+    return {(uint64_t)seed[stream], 0, 0, 0};
+}
+
+void RandomStream::PutState(const std::array<uint64_t, 4> &state)
+/* ---------------------------------------------------------------
+ * Restores the state of the current stream saved by GetState.
+ * ---------------------------------------------------------------
+ */
+{
+    if (engine == RandomEngine::XOSHIRO256PP)
+        xoshiro[stream] = state;
+    else
+        seed[stream] = (long)state[0];
 }
 
 void RandomStream::SelectStream(int index)
@@ -123,60 +294,161 @@ void RandomStream::SelectStream(int index)
  * ------------------------------------------------------------------
  */
 {
+    if (engine == RandomEngine::XOSHIRO256PP)
+    {
+        stream = index < 0 ? 0 : index;
+        if (xoshiro.empty())
+            PlantSeeds(DEFAULT);
+        while ((int)xoshiro.size() <= stream)
+            SplitXoshiro();
+        return;
+    }
     stream = ((unsigned int)index) % STREAMS;
     if ((initialized == 0) && (stream != 0)) /* protect against        */
         PlantSeeds(DEFAULT);                 /* un-initialized streams */
 }
 
+void RandomStream::UseEngine(RandomEngine engine)
+/* ---------------------------------------------------------------
+ * Switches the generator behind every stream, the streams are
+ * planted again from DEFAULT.
+ * ---------------------------------------------------------------
+ */
+{
+    this->engine = engine;
+    stream = 0;
+    xoshiro.clear();
+    PlantSeeds(DEFAULT);
+}
+
+void RandomStream::LongJump()
+/* ---------------------------------------------------------------
+ * Moves all the xoshiro streams 2^192 draws ahead, so that the
+ * streams planted from the same seed can be given to independent
+ * replications. Lehmer streams are moved with Jump instead.
+ * ---------------------------------------------------------------
+ */
+{
+    if (engine != RandomEngine::XOSHIRO256PP)
+        panic("LongJump is available only for xoshiro streams, use Jump for Lehmer seeds");
+    if (xoshiro.empty())
+        PlantSeeds(DEFAULT);
+    size_t streams = xoshiro.size();
+    JumpXoshiro(xoshiro[0], XOSHIRO_LONG_JUMP);
+    xoshiro.resize(1);
+    while (xoshiro.size() < streams)
+        SplitXoshiro();
+}
+
+long long RandomStream::MaxDraws() const
+{
+    return *std::max_element(std::begin(draws), std::end(draws));
+}
+
 RandomStream &RandomStream::Global()
 {
     static RandomStream instance{};
     return instance;
 }
 
+long RandomStream::Jump(long seed, long long draws)
+/* ---------------------------------------------------------------
+ * Returns the state reached from seed after the given number of
+ * calls to Random(), i.e. seed * MULTIPLIER^draws mod MODULUS.
+ * ---------------------------------------------------------------
+ */
+{
+    long long result = seed % MODULUS;
+    long long base = MULTIPLIER;
+    draws %= MODULUS - 1;
+    while (draws > 0)
+    {
+        if (draws & 1)
+            result = (result * base) % MODULUS;
+        base = (base * base) % MODULUS;
+        draws >>= 1;
+    }
+    return (long)result;
+}
+
 std::unique_ptr<VariableStream> RandomStream::GetStream(std::function<double(RandomStream &)> lambda)
 {
-    return std::make_unique<VariableStream>(VariableStream(generatedStreams++, lambda));
+    return std::make_unique<VariableStream>(VariableStream(*this, generatedStreams++, lambda));
 }
 
 VariableStream::VariableStream(int stream, std::function<double(RandomStream &)> lambda)
-    : stream(stream), _lambda(lambda)
+    : VariableStream(RandomStream::Global(), stream, lambda)
+{
+}
+
+VariableStream::VariableStream(RandomStream &generator, int stream, std::function<double(RandomStream &)> lambda)
+    : stream(stream), _generator(&generator), _lambda(lambda)
 {
 }
 
 double VariableStream::operator()()
 {
-    RandomStream::Global().SelectStream(stream);
-    return _lambda(RandomStream::Global());
+    if (_next < _buffer.size())
+        return _buffer[_next++];
+    _generator->SelectStream(stream);
+    if (_batch)
+    {
+        _batch(_buffer, *_generator);
+        _next = 1;
+        return _buffer[0];
+    }
+    return _lambda(*_generator);
+}
+
+VariableStream &VariableStream::WithBuffer(size_t size, std::function<void(std::span<double>, RandomStream &)> batch)
+{
+    _batch = size > 0 ? batch : nullptr;
+    _buffer.assign(size, 0.0);
+    _next = size;
+    return *this;
 }
 
-int selector(std::vector<double> alpha)
+std::vector<double> CumulativeWeights(const std::vector<double> &weights)
 {
-    std::vector<double> A{alpha};
-    for (int i = 1; i < A.size(); i++)
+    std::vector<double> A{weights};
+    for (size_t i = 1; i < A.size(); i++)
     {
-        A[i] = A[i - 1] + alpha[i];
+        A[i] = A[i - 1] + weights[i];
     }
-    auto Y = RandomStream::Global().Random();
-    auto r = 0;
-    while (Y >= A[r])
-        r++;
-    return r;
+    return A;
+}
+
+// first index whose running sum exceeds the draw, the last one with a weight when rounding leaves the sum below 1
+static int selector(RandomStream &generator, const std::vector<double> &cdf)
+{
+    auto Y = generator.Random();
+    auto r = std::upper_bound(cdf.begin(), cdf.end(), Y) - cdf.begin();
+    if (r < (long)cdf.size())
+        return (int)r;
+    r = (long)cdf.size() - 1;
+    while (r > 0 && cdf[r] == cdf[r - 1])
+        r--;
+    return (int)r;
 }
 
 double CompositionStream::operator()()
 {
-    RandomStream::Global().SelectStream(_stream);
-    return _generators[selector(_alpha)](RandomStream::Global());
+    _generator->SelectStream(_stream);
+    return _generators[selector(*_generator, _cdf)](*_generator);
 }
 
 
 int Router::operator()() {
-    RandomStream::Global().SelectStream(_stream);
-    return _indexes[selector(_p)];
+    _generator->SelectStream(_stream);
+    return _indexes[selector(*_generator, _cdf)];
 }
 
 Router::Router(int stream, std::vector<double> probs, std::vector<int> indexes)
-    : _stream(stream), _indexes(indexes), _p(probs)
+    : Router(RandomStream::Global(), stream, probs, indexes)
+{
+}
+
+Router::Router(RandomStream &generator, int stream, std::vector<double> probs, std::vector<int> indexes)
+    : _indexes(indexes), _p(probs), _cdf(CumulativeWeights(probs)), _stream(stream), _generator(&generator)
 {
 }
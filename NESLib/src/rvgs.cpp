@@ -38,22 +38,20 @@
 #include <math.h>
 #include "rngs.hpp"
 #include "rvgs.h"
+#include <vector>
 
-double Random(){
-  return RandomStream::Global().Random();
-}
 
-   long Bernoulli(double p)
+   long Bernoulli(double p, RandomStream &rng)
 /* ========================================================
  * Returns 1 with probability p or 0 with probability 1 - p. 
  * NOTE: use 0.0 < p < 1.0                                   
  * ========================================================
  */ 
 {
-  return ((Random() < (1.0 - p)) ? 0 : 1);
+  return ((rng.Random() < (1.0 - p)) ? 0 : 1);
 }
 
-   long Binomial(long n, double p)
+   long Binomial(long n, double p, RandomStream &rng)
 /* ================================================================ 
  * Returns a binomial distributed integer between 0 and n inclusive. 
  * NOTE: use n > 0 and 0.0 < p < 1.0
@@ -63,31 +61,31 @@ double Random(){
   long i, x = 0;
 
   for (i = 0; i < n; i++)
-    x += Bernoulli(p);
+    x += Bernoulli(p, rng);
   return (x);
 }
 
-   long Equilikely(long a, long b)
+   long Equilikely(long a, long b, RandomStream &rng)
 /* ===================================================================
  * Returns an equilikely distributed integer between a and b inclusive. 
  * NOTE: use a < b
  * ===================================================================
  */
 {
-  return (a + (long) ((b - a + 1) * Random()));
+  return (a + (long) ((b - a + 1) * rng.Random()));
 }
 
-   long Geometric(double p)
+   long Geometric(double p, RandomStream &rng)
 /* ====================================================
  * Returns a geometric distributed non-negative integer.
  * NOTE: use 0.0 < p < 1.0
  * ====================================================
  */
 {
-  return ((long) (log(1.0 - Random()) / log(p)));
+  return ((long) (log(1.0 - rng.Random()) / log(p)));
 }
 
-   long Pascal(long n, double p)
+   long Pascal(long n, double p, RandomStream &rng)
 /* ================================================= 
  * Returns a Pascal distributed non-negative integer. 
  * NOTE: use n > 0 and 0.0 < p < 1.0
@@ -97,11 +95,11 @@ double Random(){
   long i, x = 0;
 
   for (i = 0; i < n; i++)
-    x += Geometric(p);
+    x += Geometric(p, rng);
   return (x);
 }
 
-   long Poisson(double m)
+   long Poisson(double m, RandomStream &rng)
 /* ================================================== 
  * Returns a Poisson distributed non-negative integer. 
  * NOTE: use m > 0
@@ -112,33 +110,33 @@ double Random(){
   long   x = 0;
 
   while (t < m) {
-    t += Exponential(1.0);
+    t += Exponential(1.0, rng);
     x++;
   }
   return (x - 1);
 }
 
-   double Uniform(double a, double b)
+   double Uniform(double a, double b, RandomStream &rng)
 /* =========================================================== 
  * Returns a uniformly distributed real number between a and b. 
  * NOTE: use a < b
  * ===========================================================
  */
 { 
-  return (a + (b - a) * Random());
+  return (a + (b - a) * rng.Random());
 }
 
-   double Exponential(double m)
+   double Exponential(double m, RandomStream &rng)
 /* =========================================================
  * Returns an exponentially distributed positive real number. 
  * NOTE: use m > 0.0
  * =========================================================
  */
 {
-  return (-m * log(1.0 - Random()));
+  return (-m * log(1.0 - rng.Random()));
 }
 
-   double Erlang(long n, double b)
+   double Erlang(long n, double b, RandomStream &rng)
 /* ================================================== 
  * Returns an Erlang distributed positive real number.
  * NOTE: use n > 0 and b > 0.0
@@ -149,15 +147,12 @@ double Random(){
   double x = 0.0;
 
   for (i = 0; i < n; i++) 
-    x += Exponential(b);
+    x += Exponential(b, rng);
   return (x);
 }
 
-   double Normal(double m, double s)
+static double NormalFromUniform(double m, double s, double u)
 /* ========================================================================
- * Returns a normal (Gaussian) distributed real number.
- * NOTE: use s > 0.0
- *
  * Uses a very accurate approximation of the normal idf due to Odeh & Evans, 
  * J. Applied Statistics, 1974, vol 23, pp 96-97.
  * ========================================================================
@@ -168,9 +163,8 @@ double Random(){
   const double p2 = 0.342242088547;     const double q2 = 0.531103462366;
   const double p3 = 0.204231210245e-1;  const double q3 = 0.103537752850;
   const double p4 = 0.453642210148e-4;  const double q4 = 0.385607006340e-2;
-  double u, t, p, q, z;
+  double t, p, q, z;
 
-  u   = Random();
   if (u < 0.5)
     t = sqrt(-2.0 * log(u));
   else
@@ -184,17 +178,27 @@ double Random(){
   return (m + s * z);
 }
 
-   double Lognormal(double a, double b)
+   double Normal(double m, double s, RandomStream &rng)
+/* ========================================================================
+ * Returns a normal (Gaussian) distributed real number.
+ * NOTE: use s > 0.0
+ * ========================================================================
+ */
+{ 
+  return NormalFromUniform(m, s, rng.Random());
+}
+
+   double Lognormal(double a, double b, RandomStream &rng)
 /* ==================================================== 
  * Returns a lognormal distributed positive real number. 
  * NOTE: use b > 0.0
  * ====================================================
  */
 {
-  return (exp(a + b * Normal(0.0, 1.0)));
+  return (exp(a + b * Normal(0.0, 1.0, rng)));
 }
 
-   double Chisquare(long n)
+   double Chisquare(long n, RandomStream &rng)
 /* =====================================================
  * Returns a chi-square distributed positive real number. 
  * NOTE: use n > 0
@@ -205,18 +209,64 @@ double Random(){
   double z, x = 0.0;
 
   for (i = 0; i < n; i++) {
-    z  = Normal(0.0, 1.0);
+    z  = Normal(0.0, 1.0, rng);
     x += z * z;
   }
   return (x);
 }
 
-   double Student(long n)
+   double Student(long n, RandomStream &rng)
 /* =========================================== 
  * Returns a student-t distributed real number.
  * NOTE: use n > 0
  * ===========================================
  */
 {
-  return (Normal(0.0, 1.0) / sqrt(Chisquare(n) / n));
+  return (Normal(0.0, 1.0, rng) / sqrt(Chisquare(n, rng) / n));
+}
+
+/* --------------------------------------------------------------------------
+ * Batch versions: the uniforms of the whole batch are drawn at once with
+ * RandomStream::Fill, then transformed in place with the same expressions of
+ * the scalar versions, so the results are bit for bit the same.
+ * --------------------------------------------------------------------------
+ */
+
+   void Uniform(double a, double b, std::span<double> out, RandomStream &rng)
+{
+  rng.Fill(out);
+  for (auto &u : out)
+    u = a + (b - a) * u;
+}
+
+   void Exponential(double m, std::span<double> out, RandomStream &rng)
+{
+  rng.Fill(out);
+  for (auto &u : out)
+    u = -m * log(1.0 - u);
+}
+
+   void Erlang(long n, double b, std::span<double> out, std::vector<double> &draws, RandomStream &rng)
+{
+  draws.resize(n * out.size());
+  Exponential(b, std::span<double>(draws), rng);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = 0.0;
+    for (long j = 0; j < n; j++)
+      out[i] += draws[i * n + j];
+  }
+}
+
+   void Normal(double m, double s, std::span<double> out, RandomStream &rng)
+{
+  rng.Fill(out);
+  for (auto &u : out)
+    u = NormalFromUniform(m, s, u);
+}
+
+   void Lognormal(double a, double b, std::span<double> out, RandomStream &rng)
+{
+  Normal(0.0, 1.0, out, rng);
+  for (auto &z : out)
+    z = exp(a + b * z);
 }
@@ -7,13 +7,13 @@ struct MockScheduler : public Scheduler
 {
     void ProcessNext()
     {
-        auto evt = _eventList.Dequeue();
+        auto evt = _eventList->Dequeue();
         Route(evt);
     }
 
     Event GenEvent(double serviceTime, double occurTime, EventType type)
     {
-        return Event(fmt::format("{}", Event::GeneratedNodes), type, _clock, occurTime, serviceTime, _clock, 0);
+        return Event(NewCustomerId(), type, _clock, occurTime, serviceTime, _clock, 0);
     }
 
     MockScheduler() : Scheduler("mockScheduler")
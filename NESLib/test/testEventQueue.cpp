@@ -0,0 +1,84 @@
+#include "Collections/EventQueue.hpp"
+#include "Event.hpp"
+#include "rngs.hpp"
+#include "rvgs.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+static const EventQueueType engines[] = {EventQueueType::BINARY_HEAP, EventQueueType::PAIRING_HEAP,
+                                         EventQueueType::CALENDAR};
+
+TEST(TestEventQueue, test_fifo_on_ties)
+{
+    for (auto type : engines)
+    {
+        auto queue = EventQueue::Create(type);
+        for (int i = 0; i < 50; i++)
+            queue->Insert(Event{fmt::format("{}", i), ARRIVAL, 0, (double)(i % 5), 0, 0, i});
+        double last = -1;
+        int lastStation = -1;
+        while (queue->Count() > 0)
+        {
+            auto evt = queue->Dequeue();
+            ASSERT_LE(last, evt.OccurTime);
+            if (last == evt.OccurTime)
+            {
+                ASSERT_LT(lastStation, evt.Station);
+            }
+            last = evt.OccurTime;
+            lastStation = evt.Station;
+        }
+    }
+}
+
+TEST(TestEventQueue, test_same_order_as_list)
+{
+    // hold model: every dequeue schedules a new event in the future, with many ties
+    RandomStream saved = RandomStream::Global();
+    for (auto type : engines)
+    {
+        RandomStream::Global().PlantSeeds(123456789);
+        auto reference = EventQueue::Create(EventQueueType::SORTED_LIST);
+        auto queue = EventQueue::Create(type);
+        for (int i = 0; i < 200; i++)
+        {
+            Event evt{"J", ARRIVAL, 0, std::floor(Exponential(10)), 0, 0, i};
+            reference->Insert(evt);
+            queue->Insert(evt);
+        }
+        for (int i = 0; i < 20000; i++)
+        {
+            auto expected = reference->Dequeue();
+            auto actual = queue->Dequeue();
+            ASSERT_EQ(expected.OccurTime, actual.OccurTime);
+            ASSERT_EQ(expected.Station, actual.Station);
+            Event next{"J", ARRIVAL, 0, expected.OccurTime + std::floor(Exponential(10)), 0, 0, 200 + i};
+            reference->Insert(next);
+            queue->Insert(next);
+        }
+        ASSERT_EQ(reference->Count(), queue->Count());
+        while (reference->Count() > 0)
+            ASSERT_EQ(reference->Dequeue().Station, queue->Dequeue().Station);
+        ASSERT_EQ(0, queue->Count());
+    }
+    RandomStream::Global() = saved;
+}
+
+TEST(TestEventQueue, test_ordered_snapshot)
+{
+    for (auto type : engines)
+    {
+        auto queue = EventQueue::Create(type);
+        queue->Insert(Event{"C", ARRIVAL, 0, 30, 0, 0, 2});
+        queue->Insert(Event{"A", ARRIVAL, 0, 10, 0, 0, 0});
+        queue->Insert(Event{"B", ARRIVAL, 0, 10, 0, 0, 1});
+        auto ordered = queue->Ordered();
+        ASSERT_EQ(3, ordered.size());
+        for (int i = 0; i < 3; i++)
+            ASSERT_EQ(i, ordered[i].Station);
+        ASSERT_EQ(0, queue->Peek().Station);
+        ASSERT_EQ(3, queue->Count());
+    }
+}
@@ -0,0 +1,64 @@
+#include "Event.hpp"
+#include "EventTrace.hpp"
+#include "FCFSStation.hpp"
+#include "LogEngine.hpp"
+#include "Scheduler.hpp"
+#include <cstdio>
+#include <gtest/gtest.h>
+
+TEST(TestEventTrace, test_replay_matches_stations)
+{
+    LogEngine::CreateInstance("test.txt");
+    Scheduler sched{"traced"};
+    auto first = new FCFSStation(&sched, "first", 0);
+    auto second = new FCFSStation(&sched, "second", 1);
+    sched.AddStation(first);
+    sched.AddStation(second);
+    first->OnDeparture([&sched](auto s, Event &e) {
+        e.Station = 1;
+        e.Type = ARRIVAL;
+        sched.Schedule(e);
+    });
+    for (int i = 0; i < 200; i++)
+        sched.Schedule(sched.Create(i * 1.0, 0.5 + (i % 3) * 0.4, 0));
+    ASSERT_TRUE(sched.RecordTrace("test_trace.bin"));
+    while (sched.HasEvents())
+        sched.ProcessNext();
+    sched.StopTrace();
+
+    TraceReader reader{"test_trace.bin"};
+    ASSERT_TRUE(reader.IsValid());
+    ASSERT_EQ(800, reader.Count());
+    auto stats = ReplayTrace(reader);
+    ASSERT_EQ(2, stats.size());
+    for (auto station : {first, second})
+    {
+        auto &replayed = stats[station->stationIndex()];
+        ASSERT_EQ(station->Name(), replayed.name);
+        ASSERT_EQ(station->arrivals(), replayed.arrivals);
+        ASSERT_EQ(station->completions(), replayed.completions);
+        ASSERT_DOUBLE_EQ(station->busyTime(), replayed.busyTime);
+        ASSERT_DOUBLE_EQ(station->areaN(), replayed.areaN);
+        ASSERT_DOUBLE_EQ(station->observation(), replayed.observation);
+    }
+    std::remove("test_trace.bin");
+}
+
+TEST(TestEventTrace, test_preemption_is_not_a_completion)
+{
+    {
+        TraceWriter writer{"test_preempt.bin", {{0, "cpu"}, {1, "io"}}};
+        writer.Write(Event{7, ARRIVAL, 0, 0, 0, 0, 0});
+        writer.Write(Event{7, DEPARTURE, 0, 1, 0, 0, 0});
+        writer.Write(Event{7, DEPARTURE, 0, 2, 0, 0, 0});
+        writer.Write(Event{7, ARRIVAL, 0, 2, 0, 0, 1});
+        writer.Write(Event{7, DEPARTURE, 0, 3, 0, 0, 1});
+    }
+    TraceReader reader{"test_preempt.bin"};
+    auto stats = ReplayTrace(reader);
+    ASSERT_EQ(1, stats[0].completions);
+    ASSERT_DOUBLE_EQ(2.0, stats[0].busyTime);
+    ASSERT_EQ(1, stats[1].completions);
+    ASSERT_DOUBLE_EQ(1.0, stats[1].busyTime);
+    std::remove("test_preempt.bin");
+}
@@ -1,8 +1,11 @@
 #include "Collections/LinkedList.hpp"
 #include "Event.hpp"
 #include "LogEngine.hpp"
+#include <cstdio>
 #include <fmt/core.h>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <string>
 
 TEST(TestFormatter, test_event_format)
 {
@@ -11,6 +14,18 @@ TEST(TestFormatter, test_event_format)
     fmt::print("{}", str);
 }
 
+TEST(TestFormatter, test_event_names)
+{
+    Event named{"A", END, 10, 100, 20, 20, 0};
+    Event customer{42, ARRIVAL, 0, 1, 0, 0, 0};
+    ASSERT_EQ(named.Id, Event("A", ARRIVAL, 0, 0, 0, 0).Id);
+    static const EventName a{"A"};
+    ASSERT_EQ(named.Id, Event(a, ARRIVAL, 0, 0, 0, 0).Id);
+    ASSERT_EQ("A", named.Name());
+    ASSERT_EQ("J42", customer.Name());
+    ASSERT_EQ("J:J42,OC:1.000000,Tp:A,Station:0", makeformat("{}", customer));
+}
+
 TEST(TestFormatter, test_list_format)
 {
     DoubleLinkedList<double> linkedList{};
@@ -20,4 +35,68 @@ TEST(TestFormatter, test_list_format)
     linkedList.Enqueue(4.0);
     auto str = makeformat("{}", linkedList);
     fmt::print("{}", str);
-}
\ No newline at end of file
+}
+struct CountedFormat
+{
+    static inline int formatted = 0;
+};
+
+template <> struct fmt::formatter<CountedFormat> : formatter<string_view>
+{
+    auto format(const CountedFormat &, format_context &ctx) const -> format_context::iterator
+    {
+        CountedFormat::formatted++;
+        return fmt::format_to(ctx.out(), "counted");
+    }
+};
+
+TEST(TestFormatter, test_lazy_trace)
+{
+    LogEngine::CreateInstance("test.txt");
+    LogEngine::Instance()->PrintStdout(false);
+    TraceSource source{"lazy", 0};
+    CountedFormat value{};
+    source.Transfer("{}", value);
+    source.Debug("{}", value);
+    ASSERT_EQ(0, CountedFormat::formatted);
+    source.verbosity = (int)LogType::TRANSFER;
+    source.Information("{}", value);
+    ASSERT_EQ(1, CountedFormat::formatted);
+}
+
+TEST(TestFormatter, test_flush_writes_records)
+{
+    std::remove("test_async.txt");
+    LogEngine::CreateInstance("test_async.txt", LogOverflow::BLOCK, 16);
+    LogEngine::Instance()->PrintStdout(false);
+    for (int i = 0; i < 100; i++)
+        LogEngine::Instance()->Trace(LogType::INFORMATION, fmt::format("line{}", i));
+    LogEngine::Instance()->Flush();
+    std::ifstream file{"test_async.txt"};
+    std::string line;
+    int count = 0;
+    while (std::getline(file, line))
+        ASSERT_EQ(fmt::format("[{}]line{}", LogType::INFORMATION, count++), line);
+    ASSERT_EQ(100, count);
+    ASSERT_EQ(0, LogEngine::Instance()->Dropped());
+}
+
+TEST(TestFormatter, test_results_survive_overflow_and_shutdown)
+{
+    std::remove("test_shutdown.txt");
+    LogEngine::CreateInstance("test_shutdown.txt", LogOverflow::DROP, 4);
+    LogEngine::Instance()->PrintStdout(false);
+    for (int i = 0; i < 100; i++)
+        LogEngine::Instance()->Trace(LogType::RESULT, fmt::format("line{}", i));
+    ASSERT_EQ(0, LogEngine::Instance()->Dropped());
+    // no flush, destroying the engine writes what is still queued
+    LogEngine::DestroyInstance();
+    ASSERT_EQ(nullptr, LogEngine::Instance());
+    std::ifstream file{"test_shutdown.txt"};
+    std::string line;
+    int count = 0;
+    while (std::getline(file, line))
+        ASSERT_EQ(fmt::format("[{}]line{}", LogType::RESULT, count++), line);
+    ASSERT_EQ(100, count);
+    LogEngine::CreateInstance("test.txt");
+}
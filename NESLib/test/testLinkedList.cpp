@@ -1,4 +1,5 @@
 #include "Collections/LinkedList.hpp"
+#include "Collections/NodePool.hpp"
 #include "LogEngine.hpp"
 #include "rngs.hpp"
 #include "rvgs.h"
@@ -6,6 +7,7 @@
 #include <cstdio>
 #include <functional>
 #include <gtest/gtest.h>
+#include <memory>
 #include <queue>
 
 TEST(test_linked_list, test_enqueue)
@@ -164,4 +166,24 @@ TEST(test_linked_list, test_all)
     ASSERT_TRUE(list.All([](const char &c) { return c == 'c'; }));
     list.Enqueue('a');
     ASSERT_FALSE(list.All([](const char &c) { return c == 'c'; }));
-}
\ No newline at end of file
+}
+TEST(test_linked_list, test_pooled_nodes)
+{
+    auto pool = std::make_shared<NodePool<int>>();
+    DoubleLinkedList<int, PooledNodeAllocator<int>> first{PooledNodeAllocator<int>{pool}};
+    DoubleLinkedList<int, PooledNodeAllocator<int>> second{PooledNodeAllocator<int>{pool}};
+    std::function<bool(int, int)> comparator = [](int a, int b) { return a > b; };
+    for (int i = 0; i < 100; i++)
+        first.Insert(i % 7, comparator);
+    size_t capacity = pool->Capacity();
+    ASSERT_EQ(100, pool->InUse());
+    for (int i = 0; i < 10000; i++)
+    {
+        second.Enqueue(first.Dequeue());
+        first.Enqueue(second.Dequeue());
+    }
+    ASSERT_EQ(100, pool->InUse());
+    ASSERT_EQ(capacity, pool->Capacity());
+    first.Clear();
+    ASSERT_EQ(0, pool->InUse());
+}
@@ -38,6 +38,47 @@ TEST(TestMeasure, test_measure_add)
     ASSERT_EQ(101, measure.Count());
 }
 
+TEST(TestMeasure, test_variance_with_large_offset)
+{
+    // the squares of these values need more digits than a double has, mean of squares minus squared mean is noise
+    Accumulator<> measure{"offset", ""};
+    CovariatedMeasure ratio{"offset", ""};
+    for (int i = 0; i <= 100; i++)
+    {
+        measure(1e9 + i);
+        ratio(1e9 + (i % 2), 1.0);
+    }
+    ASSERT_NEAR(850, measure.variance(), 1e-6);
+    ASSERT_NEAR(1e9 + 50, measure.mean(), 1e-6);
+    // residuals are i % 2 - 50/101, their sum of squares is 50 * 51 / 101
+    ASSERT_NEAR(50.0 * 51.0 / 101.0 / 100.0, ratio.variance(), 1e-6);
+}
+
+TEST(TestMeasure, test_accumulator_merge)
+{
+    Accumulator<4> all{"all", ""};
+    Accumulator<4> first{"first", ""};
+    Accumulator<4> second{"second", ""};
+    for (int i = 0; i < 1000; i++)
+    {
+        double value = (i % 7) * 1.5 + (i % 13) * 0.25;
+        all(value);
+        (i < 300 ? first : second)(value);
+    }
+    first.Merge(second);
+    ASSERT_EQ(all.Count(), first.Count());
+    ASSERT_NEAR(all.mean(), first.mean(), 1e-12 * all.mean());
+    ASSERT_NEAR(all.variance(), first.variance(), 1e-12 * all.variance());
+    for (int moment = 1; moment < 4; moment++)
+        ASSERT_NEAR(all.mean(moment), first.mean(moment), 1e-9 * all.mean(moment));
+    // raw moments of 0..100
+    Accumulator<3> raw{"raw", ""};
+    for (int i = 0; i <= 100; i++)
+        raw(i);
+    ASSERT_NEAR(3350, raw.mean(1), 1e-9);
+    ASSERT_NEAR(252500, raw.mean(2), 1e-6);
+}
+
 TEST(TestRandom, test_random_generator)
 {
     RandomStream stream{};
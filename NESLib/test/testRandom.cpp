@@ -1,6 +1,7 @@
 #include "Measure.hpp"
 #include "rngs.hpp"
 #include "rvgs.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <fmt/core.h>
@@ -8,6 +9,8 @@
 #include <fmt/ranges.h>
 #include <gtest/gtest.h>
 #include <stdio.h>
+#include <string>
+#include <string_view>
 #include <vector>
 
 double mean(std::vector<double> &vals)
@@ -85,4 +88,423 @@ TEST(TestRandom, test_covariated)
     ASSERT_EQ(2, m.R());
     
     fmt::println("{:csv}",m);
-}
\ No newline at end of file
+}
+
+TEST(TestRandom, test_jump)
+{
+    RandomStream stream{};
+    stream.PlantSeeds(DEFAULT);
+    for (int i = 0; i < 1000; i++)
+        stream.Random();
+    long seed;
+    stream.GetSeed(&seed);
+    ASSERT_EQ(seed, RandomStream::Jump(DEFAULT, 1000));
+    ASSERT_EQ(DEFAULT, RandomStream::Jump(DEFAULT, 0));
+    // draws are counted per stream, so a runner can tell when a stream reached the block of the next one
+    stream.SelectStream(3);
+    std::vector<double> batch(1500);
+    stream.Fill(batch);
+    ASSERT_EQ(1500, stream.MaxDraws());
+    stream.PlantSeeds(DEFAULT);
+    ASSERT_EQ(0, stream.MaxDraws());
+}
+
+TEST(TestRandom, test_covariated_merge)
+{
+    CovariatedMeasure all{};
+    CovariatedMeasure first{};
+    CovariatedMeasure second{};
+    for (int i = 1; i <= 10; i++)
+    {
+        all(i * 2, i);
+        (i <= 4 ? first : second)(i * 2, i);
+    }
+    first.Merge(second);
+    ASSERT_EQ(all.Count(), first.Count());
+    ASSERT_DOUBLE_EQ(all.R(), first.R());
+    ASSERT_DOUBLE_EQ(all.variance(), first.variance());
+}
+
+TEST(TestRandom, test_measure_state)
+{
+    CovariatedMeasure ratio{"ratio", ""};
+    Accumulator<> acc{"acc", ""};
+    EsembledMeasure<> all{"all", ""};
+    EsembledMeasure<> first{"first", ""};
+    EsembledMeasure<> second{"second", ""};
+    for (int i = 1; i <= 10; i++)
+    {
+        ratio(i * 3, i);
+        acc(i * 0.5);
+        for (int k = 0; k < 10; k++)
+        {
+            all(i + k);
+            (i <= 5 ? first : second)(i + k);
+        }
+        all.MoveEsemble(1);
+        all[0].Reset();
+        (i <= 5 ? first : second).MoveEsemble(1);
+        (i <= 5 ? first : second)[0].Reset();
+    }
+    std::string state{};
+    ratio.Serialize(state);
+    acc.Serialize(state);
+    second.Serialize(state);
+    std::string_view view{state};
+    CovariatedMeasure ratioCopy{};
+    Accumulator<> accCopy{};
+    EsembledMeasure<> secondCopy{};
+    ASSERT_TRUE(ratioCopy.Deserialize(view));
+    ASSERT_TRUE(accCopy.Deserialize(view));
+    ASSERT_TRUE(secondCopy.Deserialize(view));
+    ASSERT_TRUE(view.empty());
+    ASSERT_FALSE(ratioCopy.Deserialize(view));
+    ASSERT_EQ(ratio.Count(), ratioCopy.Count());
+    ASSERT_EQ(ratio.R(), ratioCopy.R());
+    ASSERT_EQ(ratio.variance(), ratioCopy.variance());
+    ASSERT_EQ(acc.mean(), accCopy.mean());
+    ASSERT_EQ(acc.variance(), accCopy.variance());
+    first.Merge(secondCopy);
+    ASSERT_EQ(all[1].Count(), first[1].Count());
+    ASSERT_DOUBLE_EQ(all[1].mean(), first[1].mean());
+    ASSERT_DOUBLE_EQ(all[1].variance(), first[1].variance());
+}
+
+TEST(TestRandom, test_quantile_measure)
+{
+    RandomStream::Global().PlantSeeds(123456789);
+    QuantileMeasure all{"all", ""};
+    QuantileMeasure first{"first", ""};
+    QuantileMeasure second{"second", ""};
+    std::vector<double> samples{};
+    for (int i = 0; i < 100000; i++)
+    {
+        double value = Exponential(0.3);
+        samples.push_back(value);
+        all(value);
+        (i % 3 == 0 ? first : second)(value);
+    }
+    std::sort(samples.begin(), samples.end());
+    for (double q : {0.01, 0.25, 0.5, 0.9, 0.95, 0.99, 0.999})
+    {
+        double expected = samples[(size_t)(q * (samples.size() - 1))];
+        ASSERT_NEAR(expected, all.Quantile(q), expected * all.Accuracy()) << "quantile " << q;
+    }
+    first.Merge(second);
+    ASSERT_EQ(all.Count(), first.Count());
+    std::string state{};
+    first.Serialize(state);
+    std::string_view view{state};
+    QuantileMeasure copy{};
+    ASSERT_TRUE(copy.Deserialize(view));
+    ASSERT_TRUE(view.empty());
+    for (double q : {0.5, 0.95, 0.99})
+        ASSERT_EQ(all.Quantile(q), copy.Quantile(q));
+
+    // folding the low buckets keeps the high quantiles exact within the accuracy
+    QuantileMeasure folded{"folded", "", 0.01, 64};
+    for (int i = 0; i < 10000; i++)
+        folded(std::pow(10.0, -6 + 12.0 * i / 10000));
+    double expected = std::pow(10.0, -6 + 12.0 * 9899 / 10000);
+    ASSERT_NEAR(expected, folded.Quantile(0.99), expected * folded.Accuracy());
+}
+
+TEST(TestRandom, test_generator_per_stream)
+{
+    RandomStream saved = RandomStream::Global();
+    RandomStream::Global().PlantSeeds(DEFAULT);
+    RandomStream first{};
+    RandomStream second{};
+    first.PlantSeeds(DEFAULT);
+    second.PlantSeeds(DEFAULT);
+    VariableStream global{3, [](auto &rng) { return Exponential(10, rng); }};
+    VariableStream a{first, 3, [](auto &rng) { return Exponential(10, rng); }};
+    VariableStream b{second, 3, [](auto &rng) { return Exponential(10, rng); }};
+    Router route{first, 4, {0.5, 0.5}, {0, 1}};
+    Router expected{4, {0.5, 0.5}, {0, 1}};
+    for (int i = 0; i < 100; i++)
+    {
+        double x = a();
+        ASSERT_EQ(x, b());
+        ASSERT_EQ(x, global());
+        ASSERT_EQ(expected(), route());
+    }
+    long untouched, advanced;
+    second.SelectStream(4);
+    second.GetSeed(&untouched);
+    first.SelectStream(4);
+    first.GetSeed(&advanced);
+    ASSERT_EQ(RandomStream::Jump(untouched, 100), advanced);
+    RandomStream::Global() = saved;
+}
+
+TEST(TestRandom, test_xoshiro_streams)
+{
+    RandomStream first{RandomEngine::XOSHIRO256PP};
+    RandomStream second{RandomEngine::XOSHIRO256PP};
+    first.PlantSeeds(DEFAULT);
+    second.PlantSeeds(DEFAULT);
+    first.SelectStream(1000);
+    second.SelectStream(1000);
+    double sum = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        double u = first.Random();
+        ASSERT_EQ(u, second.Random());
+        ASSERT_GT(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+    }
+    ASSERT_NEAR(0.5, sum / 100000, 0.01);
+    // the seed is only a fingerprint of the 256 bit state, the state itself round trips
+    auto state = first.GetState();
+    long fingerprint;
+    first.GetSeed(&fingerprint);
+    double next = first.Random();
+    second.PutSeed(fingerprint);
+    ASSERT_NE(next, second.Random());
+    second.PutState(state);
+    ASSERT_EQ(next, second.Random());
+    second.SelectStream(999);
+    ASSERT_NE(first.Random(), second.Random());
+    RandomStream jumped{RandomEngine::XOSHIRO256PP};
+    jumped.PlantSeeds(DEFAULT);
+    jumped.LongJump();
+    first.PlantSeeds(DEFAULT);
+    first.SelectStream(0);
+    jumped.SelectStream(0);
+    ASSERT_NE(first.Random(), jumped.Random());
+    RandomStream lehmer{RandomEngine::LEHMER};
+    RandomStream reference{};
+    reference.PlantSeeds(DEFAULT);
+    ASSERT_EQ(reference.Random(), lehmer.Random());
+}
+
+TEST(TestRandom, test_batch_matches_scalar)
+{
+    for (auto engine : {RandomEngine::LEHMER, RandomEngine::XOSHIRO256PP})
+    {
+        RandomStream scalar{engine};
+        RandomStream batch{engine};
+        scalar.PlantSeeds(DEFAULT);
+        batch.PlantSeeds(DEFAULT);
+        scalar.SelectStream(7);
+        batch.SelectStream(7);
+        std::vector<double> scratch{};
+        for (size_t size : {0, 1, 7, 8, 9, 16, 100})
+        {
+            std::vector<double> uniforms(size);
+            batch.Fill(uniforms);
+            for (double u : uniforms)
+                ASSERT_EQ(scalar.Random(), u);
+            std::vector<double> exponentials(size);
+            Exponential(10, exponentials, batch);
+            for (double x : exponentials)
+                ASSERT_EQ(Exponential(10, scalar), x);
+            std::vector<double> normals(size);
+            Normal(1, 2, normals, batch);
+            for (double x : normals)
+                ASSERT_EQ(Normal(1, 2, scalar), x);
+            std::vector<double> erlangs(size);
+            Erlang(3, 5, erlangs, scratch, batch);
+            for (double x : erlangs)
+                ASSERT_EQ(Erlang(3, 5, scalar), x);
+        }
+        ASSERT_EQ(scalar.Random(), batch.Random());
+    }
+}
+
+TEST(TestRandom, test_buffered_stream)
+{
+    RandomStream first{};
+    RandomStream second{};
+    first.PlantSeeds(DEFAULT);
+    second.PlantSeeds(DEFAULT);
+    VariableStream scalar{first, 2, [](auto &rng) { return Exponential(20, rng); }};
+    VariableStream buffered{second, 2, [](auto &rng) { return Exponential(20, rng); }};
+    buffered.WithBuffer(64, [](auto out, auto &rng) { Exponential(20, out, rng); });
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(scalar(), buffered());
+}
+
+TEST(TestRandom, test_routing_table)
+{
+    RandomStream first{};
+    RandomStream second{};
+    first.PlantSeeds(DEFAULT);
+    second.PlantSeeds(DEFAULT);
+    std::vector<double> p{0.065, 0.025, 0.01, 0.9, 0.0};
+    Router router{first, 4, p, {10, 11, 12, 13, 14}};
+    second.SelectStream(4);
+    for (int i = 0; i < 100000; i++)
+    {
+        // the linear scan over the running sums that the table replaces
+        double y = second.Random();
+        int r = 0;
+        double sum = p[0];
+        while (y >= sum)
+            sum += p[++r];
+        ASSERT_EQ(10 + r, router());
+    }
+    // draws past a total below 1 go to the last outcome that has a weight, never to a trailing zero
+    Router short_sum{first, 5, {0.3, 0.3, 0.0}, {0, 1, 2}};
+    for (int i = 0; i < 10000; i++)
+        ASSERT_NE(2, short_sum());
+}
+
+TEST(TestRandom, test_spilled_samples)
+{
+    std::string path = "test_samples.bin";
+    {
+        BufferedMeasure<> measure{"spilled", "", 100, path};
+        for (int i = 0; i < 1050; i++)
+        {
+            measure(i);
+            ASSERT_LE(measure.Data().Window().size(), 100);
+        }
+        ASSERT_EQ(1000, measure.Data().Spilled());
+        ASSERT_EQ(1050, measure.Data().Size());
+        auto samples = measure.Map();
+        ASSERT_TRUE(samples.IsValid());
+        ASSERT_EQ(1050, samples.size());
+        double sum = 0.0;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            ASSERT_EQ((double)i, samples[i]);
+            sum += samples[i];
+        }
+        ASSERT_DOUBLE_EQ(measure.sum(), sum);
+        measure.Reset();
+        ASSERT_EQ(0, measure.Data().Size());
+    }
+    MappedSamples empty{path};
+    ASSERT_FALSE(empty.IsValid());
+    std::remove(path.c_str());
+
+    BufferedMeasure<> inMemory{"memory", ""};
+    for (int i = 0; i < 10000; i++)
+        inMemory(i);
+    ASSERT_EQ(10000, inMemory.Data().Window().size());
+    ASSERT_FALSE(inMemory.Map().IsValid());
+
+#ifndef _WIN32
+    // every write fails, the samples stay in memory and no partial file is mapped
+    BufferedMeasure<> full{"full", "", 10, "/dev/full"};
+    for (int i = 0; i < 25; i++)
+        full(i);
+    ASSERT_EQ(0, full.Data().Spilled());
+    ASSERT_EQ(25, full.Data().Window().size());
+    ASSERT_EQ(24.0, full.Data().Window().back());
+    ASSERT_FALSE(full.Map().IsValid());
+#endif
+}
+
+TEST(TestRandom, test_batch_means)
+{
+    RandomStream::Global().PlantSeeds(123456789);
+    // AR(1) with mean 10, consecutive samples are strongly correlated
+    BatchMeansMeasure correlated{"correlated", ""};
+    BatchMeansMeasure independent{"independent", ""};
+    double x = 10.0;
+    for (int i = 0; i < 20000; i++)
+    {
+        x = 10.0 + 0.99 * (x - 10.0) + Normal(0.0, 1.0);
+        correlated(x);
+        independent(Normal(10.0, 3.0));
+    }
+    ASSERT_LE(correlated.Batches(), 256);
+    // the stored batches are still correlated, the interval uses larger ones
+    ASSERT_GT(correlated.Autocorrelation(1), 0.2);
+    ASSERT_GT(correlated.BatchSize(), 128);
+    ASSERT_TRUE(correlated.confidence().isInTval(10.0));
+    ASSERT_TRUE(correlated.Ready(0.2));
+    ASSERT_FALSE(correlated.Ready(0.01));
+    ASSERT_TRUE(independent.confidence().isInTval(10.0));
+    ASSERT_EQ(128, independent.BatchSize());
+
+    // the batches of an independent run are appended at the common batch size
+    BatchMeansMeasure other{"other", ""};
+    for (int i = 0; i < 1000; i++)
+        other(Normal(10.0, 3.0));
+    size_t count = independent.Count();
+    independent.Merge(other);
+    // the batches of other that do not pair at the larger size are left out, and so are their samples
+    ASSERT_GT(independent.Count(), count);
+    ASSERT_LE(independent.Count(), count + 1000);
+    ASSERT_LE(independent.Batches(), 256);
+    // 45 samples fill 20 batches of 2 and 2 more, the partial batch of the last sample is not merged
+    BatchMeansMeasure partial{"partial", "", 40};
+    for (int i = 0; i < 45; i++)
+        partial(i);
+    BatchMeansMeasure merged{"merged", "", 40};
+    merged.Merge(partial);
+    ASSERT_EQ(45, partial.Count());
+    ASSERT_EQ(22, merged.Batches());
+    ASSERT_EQ(44, merged.Count());
+    ASSERT_DOUBLE_EQ(21.5, merged.mean());
+    std::string state{};
+    independent.Serialize(state);
+    std::string_view view{state};
+    BatchMeansMeasure copy{};
+    ASSERT_TRUE(copy.Deserialize(view));
+    ASSERT_EQ(independent.mean(), copy.mean());
+    ASSERT_EQ(independent.BatchSize(), copy.BatchSize());
+
+    BatchMeansMeasure warm{"warm", ""};
+    warm.WithWarmup(100);
+    for (int i = 0; i < 100; i++)
+        warm(1000.0);
+    for (int i = 0; i < 1000; i++)
+        warm(1.0);
+    ASSERT_EQ(1000, warm.Count());
+    ASSERT_DOUBLE_EQ(1.0, warm.mean());
+}
+
+TEST(TestRandom, test_warmup_detection)
+{
+    RandomStream::Global().PlantSeeds(123456789);
+    WarmupDetector drifting{};
+    WarmupDetector stationary{};
+    int i = 0;
+    for (; i < 5000 && (drifting.Transitory() || stationary.Transitory()); i++)
+    {
+        drifting.Push(10.0 + 40.0 * std::exp(-i / 100.0) + Normal(0.0, 1.0));
+        stationary.Push(Normal(10.0, 1.0));
+    }
+    ASSERT_FALSE(drifting.Transitory());
+    ASSERT_FALSE(stationary.Transitory());
+    // the bias is below the noise after about 4 time constants
+    ASSERT_GT(drifting.TruncationPoint(), 200);
+    ASSERT_LT(drifting.TruncationPoint(), 1000);
+    ASSERT_LT(stationary.TruncationPoint(), drifting.TruncationPoint());
+    drifting.Reset();
+    ASSERT_TRUE(drifting.Transitory());
+    ASSERT_EQ(0, drifting.Observations());
+
+    MobileMeanMeasure means{1, 10};
+    for (int k = 0; k < 10; k++)
+        means.push(k);
+    ASSERT_DOUBLE_EQ(-1.0, means.delta());
+}
+
+TEST(TestRandom, test_samples_for_precision)
+{
+    RandomStream::Global().PlantSeeds(123456789);
+    CovariatedMeasure ratio{"ratio", ""};
+    ratio.WithConfidence(0.90).WithPrecision(0.01);
+    auto sample = [&ratio]() {
+        double time = Exponential(10.0);
+        ratio(2.0 * time + Normal(0.0, 5.0), time);
+    };
+    for (int i = 0; i < 200; i++)
+        sample();
+    ASSERT_GT(ratio.confidence().precision(), 0.01);
+    int needs = ratio.SampleNeedsForPrecision();
+    ASSERT_GT(needs, 200);
+    // a looser precision needs fewer samples and leaves the one of the measure alone
+    ASSERT_LT(ratio.SampleNeedsForPrecision(0.05), needs);
+    ASSERT_EQ(needs, ratio.SampleNeedsForPrecision());
+    while (ratio.Count() < (size_t)needs)
+        sample();
+    ASSERT_NEAR(0.01, ratio.confidence().precision(), 0.002);
+}
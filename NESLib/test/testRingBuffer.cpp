@@ -0,0 +1,53 @@
+#include "Collections/RingBuffer.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TestRingBuffer, test_bounded)
+{
+    RingBuffer<int> ring{5};
+    ASSERT_EQ(8, ring.Capacity());
+    for (int i = 0; i < 8; i++)
+        ASSERT_TRUE(ring.TryPush(int{i}));
+    ASSERT_FALSE(ring.TryPush(8));
+    int value = -1;
+    ASSERT_TRUE(ring.TryPop(value));
+    ASSERT_EQ(0, value);
+    ASSERT_TRUE(ring.TryPush(8));
+    for (int i = 1; i <= 8; i++)
+    {
+        ASSERT_TRUE(ring.TryPop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(ring.TryPop(value));
+}
+
+TEST(TestRingBuffer, test_multiple_producers)
+{
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    RingBuffer<int> ring{64};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < perProducer; i++)
+                while (!ring.TryPush(p * perProducer + i))
+                    std::this_thread::yield();
+        });
+    // each producer must be seen in order, and every value exactly once
+    std::vector<int> last(producers, -1);
+    int value;
+    for (int received = 0; received < producers * perProducer;)
+    {
+        if (!ring.TryPop(value))
+            continue;
+        int p = value / perProducer;
+        ASSERT_LT(last[p], value % perProducer);
+        last[p] = value % perProducer;
+        received++;
+    }
+    for (auto &t : threads)
+        t.join();
+    for (int p = 0; p < producers; p++)
+        ASSERT_EQ(perProducer - 1, last[p]);
+}
@@ -1,15 +1,19 @@
 #include "DataCollector.hpp"
 #include "Event.hpp"
 #include "FCFSStation.hpp"
+#include "Hooks.hpp"
 #include "LogEngine.hpp"
 #include "Measure.hpp"
+#include "StaticScheduler.hpp"
 #include "Station.hpp"
 #include "rngs.hpp"
 #include "TestEnv.hpp"
 #include "gtest/gtest.h"
 #include <fmt/base.h>
 #include <fmt/core.h>
+#include <array>
 #include <memory>
+#include <string>
 
 TEST(TestStation, test_onarrival)
 {
@@ -22,6 +26,142 @@ TEST(TestStation, test_onarrival)
     ASSERT_EQ(1, a);
 }
 
+TEST(TestStation, test_hooks)
+{
+    LogEngine::CreateInstance("test.txt");
+    BaseStation s{"test"};
+    int calls = 0;
+    int removedCalls = 0;
+    int once = 0;
+    int added = 0;
+    HookId removed = 0;
+    auto id = s.OnArrival([&](auto station, Event &e) {
+        // removing a hook not run yet and adding another one while dispatching
+        if (++calls == 2)
+        {
+            s.RemoveHook(removed);
+            s.OnArrival([&added](auto station, Event &e) { added++; });
+        }
+    });
+    removed = s.OnArrival([&removedCalls](auto station, Event &e) { removedCalls++; });
+    s.OnArrivalOnce([&once](auto station, Event &e) { once++; });
+    auto arrive = [&s](double clock) {
+        auto evt = Event("test", ARRIVAL, clock, clock, 0, clock, 0);
+        s.Process(evt);
+    };
+    arrive(0);
+    ASSERT_EQ(1, removedCalls);
+    ASSERT_EQ(1, once);
+    arrive(1);
+    ASSERT_EQ(1, removedCalls);
+    ASSERT_EQ(1, once);
+    ASSERT_EQ(0, added);
+    arrive(2);
+    ASSERT_EQ(1, added);
+    ASSERT_TRUE(s.RemoveHook(id));
+    ASSERT_FALSE(s.RemoveHook(id));
+    arrive(3);
+    ASSERT_EQ(3, calls);
+    ASSERT_EQ(2, added);
+
+    // captures larger than the inline buffer go to the heap
+    std::string name(100, 'x');
+    std::array<double, 16> large{};
+    size_t length = 0;
+    s.OnArrivalOnce([name, large, &length](auto station, Event &e) { length = name.size() + large.size(); });
+    arrive(4);
+    ASSERT_EQ(116, length);
+}
+
+TEST(TestStation, test_nested_hooks)
+{
+    LogEngine::CreateInstance("test.txt");
+    HookList<int &> hooks{};
+    int outer = 0;
+    int removedCalls = 0;
+    int added = 0;
+    hooks.Add(1, [&](int &depth) {
+        outer++;
+        if (depth++ == 0)
+        {
+            // the nested dispatch must not compact the list the outer one is walking
+            hooks.Remove(2);
+            hooks.Add(3, [&added](int &) { added++; });
+            hooks.Dispatch(depth);
+        }
+    });
+    hooks.Add(2, [&removedCalls](int &) { removedCalls++; });
+    int depth = 0;
+    hooks.Dispatch(depth);
+    ASSERT_EQ(2, outer);
+    ASSERT_EQ(0, removedCalls);
+    ASSERT_EQ(0, added);
+    ASSERT_EQ(2, hooks.Size());
+    hooks.Dispatch(depth);
+    ASSERT_EQ(3, outer);
+    ASSERT_EQ(1, added);
+
+    HookList<int &> once{};
+    int first = 0;
+    int second = 0;
+    bool cancelled = false;
+    once.Add(1, [&](int &n) {
+        first++;
+        // the second hook is still pending, then the nested dispatch finds nothing left to run
+        cancelled = once.Remove(2);
+        once.DispatchOnce(n);
+    });
+    once.Add(2, [&second](int &) { second++; });
+    int n = 0;
+    once.DispatchOnce(n);
+    ASSERT_EQ(1, first);
+    ASSERT_TRUE(cancelled);
+    ASSERT_EQ(0, second);
+    ASSERT_TRUE(once.Empty());
+
+    // a pending once hook removed from the station never fires
+    BaseStation s{"test"};
+    int fired = 0;
+    auto id = s.OnArrivalOnce([&fired](auto station, Event &e) { fired++; });
+    ASSERT_TRUE(s.RemoveHook(id));
+    auto evt = Event("test", ARRIVAL, 0, 0, 0, 0, 0);
+    s.Process(evt);
+    ASSERT_EQ(0, fired);
+    ASSERT_FALSE(s.RemoveHook(id));
+}
+
+TEST(TestStation, test_population_statistics)
+{
+    LogEngine::CreateInstance("test.txt");
+    BaseStation s{"test"};
+    auto process = [&s](EventType type, double clock) {
+        auto evt = Event("test", type, clock, clock, 0, clock, 0);
+        s.Process(evt);
+    };
+    process(ARRIVAL, 0);
+    process(ARRIVAL, 1);
+    process(PROBE, 2);
+    process(DEPARTURE, 3);
+    ASSERT_DOUBLE_EQ(5, s.areaN());
+    process(DEPARTURE, 4);
+    process(PROBE, 6);
+    ASSERT_DOUBLE_EQ(6, s.areaN());
+    ASSERT_DOUBLE_EQ(2, s.areaS());
+    ASSERT_DOUBLE_EQ(4, s.busyTime());
+    ASSERT_DOUBLE_EQ(6, s.observation());
+    auto histogram = s.population_histogram();
+    ASSERT_EQ(3, histogram.size());
+    for (auto time : histogram)
+        ASSERT_DOUBLE_EQ(2, time);
+    ASSERT_EQ(1, s.population_percentile(0.5));
+    ASSERT_EQ(2, s.population_percentile(0.9));
+    s.Reset();
+    process(ARRIVAL, 7);
+    process(PROBE, 10);
+    ASSERT_DOUBLE_EQ(3, s.areaN());
+    ASSERT_DOUBLE_EQ(4, s.observation());
+}
+
 TEST(TestStation, test_fcfs_arrival)
 {
     LogEngine::CreateInstance("test.txt");
@@ -38,3 +178,150 @@ TEST(TestStation, test_fcfs_arrival)
 
 
 
+
+TEST(TestStation, test_station_lookup)
+{
+    LogEngine::CreateInstance("test.txt");
+    MockScheduler sched{};
+    auto first = new FCFSStation(&sched, "first", 3);
+    auto second = new FCFSStation(&sched, "second", 7);
+    sched.AddStation(first);
+    sched.AddStation(second);
+    ASSERT_EQ(first, sched.GetStation(3).value().get());
+    ASSERT_EQ(second, sched.GetStation("second").value().get());
+    ASSERT_FALSE(sched.GetStation(5).has_value());
+    ASSERT_FALSE(sched.GetStation(-1).has_value());
+    ASSERT_FALSE(sched.GetStation("third").has_value());
+    auto evt = sched.GenEvent(10, 10, ARRIVAL);
+    evt.Station = 7;
+    sched.Schedule(evt);
+    sched.ProcessNext();
+    ASSERT_EQ(1, second->arrivals());
+    ASSERT_EQ(0, first->arrivals());
+}
+
+struct CountingStation final : public Station
+{
+    int counted = 0;
+
+    CountingStation(int index) : Station("counting", index)
+    {
+    }
+
+    void ProcessArrival(Event &evt) override
+    {
+        Station::ProcessArrival(evt);
+        counted++;
+    }
+};
+
+TEST(TestStation, test_static_scheduler)
+{
+    LogEngine::CreateInstance("test.txt");
+    StaticScheduler<FCFSStation, CountingStation> sched{"static"};
+    Scheduler dynamic{"dynamic"};
+    auto fcfs = new FCFSStation(&sched, "fcfs", 0);
+    auto counting = new CountingStation(1);
+    // not in the list, still reached through the virtual calls
+    auto other = new Station("other", 2);
+    auto reference = new FCFSStation(&dynamic, "fcfs", 0);
+    sched.AddStation(fcfs).AddStation(counting).AddStation(other);
+    dynamic.AddStation(reference);
+    ASSERT_TRUE(sched.IsStatic(0));
+    ASSERT_TRUE(sched.IsStatic(1));
+    ASSERT_FALSE(sched.IsStatic(2));
+    ASSERT_FALSE(sched.IsStatic(3));
+
+    for (int i = 0; i < 5; i++)
+    {
+        sched.Schedule(sched.Create(i * 2.0, 3.0, 0));
+        dynamic.Schedule(dynamic.Create(i * 2.0, 3.0, 0));
+    }
+    sched.Schedule(sched.Create(1.0, 0.0, 1));
+    sched.Schedule(sched.Create(1.5, 0.0, 2));
+    while (sched.HasEvents())
+        sched.ProcessNext();
+    while (dynamic.HasEvents())
+        dynamic.ProcessNext();
+
+    ASSERT_EQ(5, fcfs->completions());
+    ASSERT_EQ(reference->completions(), fcfs->completions());
+    ASSERT_DOUBLE_EQ(reference->areaN(), fcfs->areaN());
+    ASSERT_DOUBLE_EQ(reference->clock(), fcfs->clock());
+    ASSERT_EQ(1, counting->counted);
+    ASSERT_EQ(1, counting->arrivals());
+    ASSERT_EQ(1, other->arrivals());
+}
+
+TEST(TestStation, test_station_table)
+{
+    LogEngine::CreateInstance("test.txt");
+    MockScheduler sched{};
+    auto first = new FCFSStation(&sched, "first", 0);
+    auto second = new FCFSStation(&sched, "second", 1);
+    // counters gathered before the registration move with the station
+    auto early = Event("early", ARRIVAL, 0, 0, 5, 0, 1);
+    second->Process(early);
+    sched.AddStation(first).AddStation(second);
+    ASSERT_EQ(2, sched.GetStationTable().Size());
+    ASSERT_EQ(1, sched.GetStationTable()[second->slot()].arrivals);
+
+    for (int i = 0; i < 4; i++)
+        sched.Schedule(sched.GenEvent(1, i + 1, ARRIVAL));
+    while (sched.HasEvents())
+        sched.ProcessNext();
+    auto snapshot = sched.GetStationTable().Snapshot();
+    ASSERT_EQ(4, snapshot[first->slot()].arrivals);
+    ASSERT_EQ(first->arrivals(), snapshot[first->slot()].arrivals);
+    ASSERT_EQ(first->completions(), snapshot[first->slot()].completions);
+    ASSERT_DOUBLE_EQ(first->areaN(), snapshot[first->slot()].population.Area(first->clock()));
+
+    // the snapshot is a copy, resetting the stations leaves it as it was
+    first->Reset();
+    ASSERT_EQ(0, first->arrivals());
+    ASSERT_EQ(4, snapshot[first->slot()].arrivals);
+}
+
+TEST(TestStation, test_lazy_sync)
+{
+    LogEngine::CreateInstance("test.txt");
+    MockScheduler sched{};
+    auto station = new FCFSStation(&sched, "fcfs", 0);
+    sched.AddStation(station);
+    sched.Schedule(sched.GenEvent(10, 2, ARRIVAL));
+    sched.ProcessNext();
+    ASSERT_DOUBLE_EQ(2, station->clock());
+
+    // statistics as of a later time leave the station as it was
+    ASSERT_DOUBLE_EQ(3, station->areaN(5));
+    ASSERT_DOUBLE_EQ(5, station->observation(5));
+    ASSERT_DOUBLE_EQ(3, station->busyTime(5));
+    ASSERT_DOUBLE_EQ(0, station->areaS(5));
+    ASSERT_DOUBLE_EQ(2, station->clock());
+    ASSERT_DOUBLE_EQ(0, station->areaN());
+
+    station->AdvanceTo(5);
+    ASSERT_DOUBLE_EQ(5, station->clock());
+    ASSERT_DOUBLE_EQ(3, station->areaN());
+    ASSERT_EQ(1, station->arrivals());
+
+    // the table grows and its records move, the stations registered before follow them
+    auto other = new FCFSStation(&sched, "other", 1);
+    sched.AddStation(other);
+    ASSERT_EQ(1, station->arrivals());
+    // a sync of the scheduler brings every station of the table to its clock at once
+    auto tick = Event("tick", NO_EVENT, 8, 8, 0, 8, -1);
+    sched.Process(tick);
+    sched.Sync();
+    ASSERT_DOUBLE_EQ(8, station->clock());
+    ASSERT_DOUBLE_EQ(8, other->clock());
+    ASSERT_DOUBLE_EQ(6, station->areaN());
+    ASSERT_DOUBLE_EQ(8, other->observation());
+    // and a reset starts the observation of all of them there
+    sched.Reset();
+    ASSERT_EQ(0, station->arrivals());
+    ASSERT_EQ(1, station->sysClients());
+    ASSERT_DOUBLE_EQ(0, station->areaN());
+    ASSERT_DOUBLE_EQ(2, station->areaN(10));
+    ASSERT_DOUBLE_EQ(0, other->observation());
+}
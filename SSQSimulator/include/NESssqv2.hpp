@@ -5,13 +5,22 @@
 #include "ISimulator.hpp"
 #include "LogEngine.hpp"
 #include "Scheduler.hpp"
+#include "StaticScheduler.hpp"
 #include "Station.hpp"
+#include "Usings.hpp"
 #include "rngs.hpp"
 #include <iostream>
 
-using EventList = DoubleLinkedList<Event>;
+// the single server of the model, final so that its events are processed without virtual calls
+class SsqServer final : public FCFSStation
+{
+  public:
+    using FCFSStation::FCFSStation;
+};
+
+using SsqScheduler = StaticScheduler<SsqServer>;
 
-class NESssq : public Scheduler, public ISimulator
+class NESssq : public SsqScheduler, public ISimulator
 {
   protected:
     bool _end = false;
@@ -25,7 +34,8 @@ class NESssq : public Scheduler, public ISimulator
 
     NESssq &EndTime(double endTime)
     {
-        auto evt = Event{"END", END, 0, endTime, 0, endTime, 0};
+        static const EventName end{"END"};
+        auto evt = Event{end, END, 0, endTime, 0, endTime, 0};
         Schedule(evt);
         return *this;
     }
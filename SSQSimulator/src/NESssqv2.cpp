@@ -14,10 +14,11 @@
 #include <string>
 
 NESssq::NESssq()
-    : Scheduler("scheduler"), _serviceTimes(VariableStream{2, [](auto generator) { return Exponential(1 / 0.14); }}),
-      _interArrivals(VariableStream{1, [](RandomStream generator) { return Exponential(1 / 0.1); }})
+    : SsqScheduler("scheduler"),
+      _serviceTimes(VariableStream{2, [](auto &generator) { return Exponential(1 / 0.14, generator); }}),
+      _interArrivals(VariableStream{1, [](auto &generator) { return Exponential(1 / 0.1, generator); }})
 {
-    Scheduler::_stations.push_back(sptr<Station>(new FCFSStation{this, "server", 1}));
+    AddStation(new SsqServer{this, "server", 1});
 }
 
 void NESssq::Initialize()
@@ -33,9 +34,9 @@ void NESssq::Execute()
     while (!_end)
     {
         auto ref = (*this)["server"].value();
-        _logger.Transfer("Schedule Queue:{}", _eventList);
+        _logger.Transfer("Schedule Queue:{}", *_eventList);
         _logger.Transfer("Server Queue:{}", std::static_pointer_cast<FCFSStation>(ref)->GetEventList());
-        auto inProcess = _eventList.Dequeue();
+        auto inProcess = _eventList->Dequeue();
         Process(inProcess);
 
         inProcess.Station = 1;
@@ -64,7 +65,7 @@ void NESssq::ProcessEnd(Event &evt)
 
 void NESssq::ProcessArrival(Event &evt)
 {
-    Scheduler::ProcessArrival(evt);
+    SsqScheduler::ProcessArrival(evt);
     auto nextEvt = Create(_interArrivals(), _serviceTimes());
     _logger.Information("Created:{}", nextEvt);
     Schedule(nextEvt);
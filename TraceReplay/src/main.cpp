@@ -0,0 +1,28 @@
+#include "EventTrace.hpp"
+#include "argparse/argparse.hpp"
+#include <fmt/core.h>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    argparse::ArgumentParser parser("trace_replay");
+    parser.add_argument("trace").help("Binary trace recorded with the trace command of a simulator");
+    parser.parse_args(argc, argv);
+    auto file = parser.get<std::string>("trace");
+    TraceReader reader{file};
+    if (!reader.IsValid())
+    {
+        fmt::println("{} is not a trace file", file);
+        return 1;
+    }
+    auto stats = ReplayTrace(reader);
+    fmt::println("{} events", reader.Count());
+    fmt::println("{:>4} {:<16} {:>10} {:>10} {:>12} {:>12} {:>12} {:>12} {:>8}", "idx", "station", "arrivals",
+                 "completions", "throughput", "utilization", "mean N", "mean R", "max N");
+    for (auto &[index, s] : stats)
+    {
+        fmt::println("{:>4} {:<16} {:>10} {:>10} {:>12.6f} {:>12.6f} {:>12.6f} {:>12.6f} {:>8}", index, s.name,
+                     s.arrivals, s.completions, s.throughput(), s.utilization(), s.mean_customer_system(),
+                     s.avg_response(), s.maxClients);
+    }
+}